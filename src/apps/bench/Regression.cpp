@@ -0,0 +1,355 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Regression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace VectorFitting {
+
+namespace {
+
+// Order-statistic bounds of a 95% confidence interval of the median.
+const double z95 = 1.96;
+
+std::string formatTime(const double seconds) {
+    std::ostringstream res;
+    res << std::fixed << std::setprecision(3);
+    if (seconds < 1e-6) {
+        res << seconds * 1e9 << " ns";
+    } else if (seconds < 1e-3) {
+        res << seconds * 1e6 << " us";
+    } else if (seconds < 1.0) {
+        res << seconds * 1e3 << " ms";
+    } else {
+        res << seconds << " s";
+    }
+    return res.str();
+}
+
+const char* getVerdictName(const Regression::Verdict verdict) {
+    switch (verdict) {
+    case Regression::unchanged:
+        return "ok";
+    case Regression::faster:
+        return "FASTER";
+    case Regression::slower:
+        return "SLOWER";
+    case Regression::lessAccurate:
+        return "LESS ACCURATE";
+    case Regression::added:
+        return "new";
+    case Regression::removed:
+        return "missing";
+    }
+    return "";
+}
+
+bool worsened(const double current, const double baseline,
+              const double tolerance) {
+    // Absolute floor so that exact fits, rmse near zero, do not fail on
+    // rounding alone.
+    return current > baseline * (1.0 + tolerance) + 1e-13;
+}
+
+// Values of the flat object starting at the brace in position begin.
+std::map<std::string, std::string> parseObject(const std::string& text,
+                                               const std::size_t begin) {
+    const std::size_t end = text.find('}', begin);
+    if (end == std::string::npos) {
+        throw std::runtime_error("Unterminated object in baseline");
+    }
+    std::map<std::string, std::string> res;
+    std::size_t pos = begin + 1;
+    while (true) {
+        const std::size_t keyBegin = text.find('"', pos);
+        if (keyBegin == std::string::npos || keyBegin > end) {
+            break;
+        }
+        const std::size_t keyEnd = text.find('"', keyBegin + 1);
+        const std::size_t colon = text.find(':', keyEnd);
+        if (keyEnd == std::string::npos || colon == std::string::npos) {
+            throw std::runtime_error("Malformed object in baseline");
+        }
+        std::size_t valueBegin = text.find_first_not_of(" \t\r\n", colon + 1);
+        std::size_t valueEnd;
+        if (text[valueBegin] == '"') {
+            valueEnd = text.find('"', ++valueBegin);
+            pos = valueEnd + 1;
+        } else {
+            valueEnd = text.find_first_of(",}", valueBegin);
+            pos = valueEnd;
+        }
+        res[text.substr(keyBegin + 1, keyEnd - keyBegin - 1)] =
+                text.substr(valueBegin, valueEnd - valueBegin);
+    }
+    return res;
+}
+
+} /* namespace */
+
+Regression::Regression(benchmark::BenchmarkReporter* display)
+:   display_(display),
+    threshold_(0.05),
+    accuracyTolerance_(0.01) {}
+
+bool Regression::ReportContext(const Context& context) {
+    if (display_ != NULL) {
+        return display_->ReportContext(context);
+    }
+    return true;
+}
+
+void Regression::ReportRuns(const std::vector<Run>& reports) {
+    for (std::size_t i = 0; i < reports.size(); ++i) {
+        const Run& run = reports[i];
+        if (run.run_type != Run::RT_Iteration || run.error_occurred ||
+                run.iterations == 0) {
+            continue;
+        }
+        Measurements& measurements = measurements_[run.benchmark_name()];
+        measurements.times.push_back(
+                run.real_accumulated_time / (double) run.iterations);
+        for (benchmark::UserCounters::const_iterator it =
+                run.counters.begin(); it != run.counters.end(); ++it) {
+            measurements.counters[it->first] = it->second.value;
+        }
+    }
+    if (display_ != NULL) {
+        display_->ReportRuns(reports);
+    }
+}
+
+void Regression::Finalize() {
+    if (display_ != NULL) {
+        display_->Finalize();
+    }
+}
+
+std::vector<Regression::Summary> Regression::getSummaries() const {
+    std::vector<Summary> res;
+    for (std::map<std::string, Measurements>::const_iterator it =
+            measurements_.begin(); it != measurements_.end(); ++it) {
+        Summary summary = summarize(it->first, it->second.times);
+        const std::map<std::string, double>& counters = it->second.counters;
+        if (counters.count("rmse") && counters.count("maxDeviation")) {
+            summary.hasAccuracy = true;
+            summary.rmse = counters.find("rmse")->second;
+            summary.maxDeviation = counters.find("maxDeviation")->second;
+        }
+        res.push_back(summary);
+    }
+    return res;
+}
+
+std::vector<Regression::Comparison> Regression::compare(
+        const std::vector<Summary>& baseline) const {
+    std::map<std::string, Summary> previous;
+    for (std::size_t i = 0; i < baseline.size(); ++i) {
+        previous[baseline[i].name] = baseline[i];
+    }
+    std::vector<Comparison> res;
+    const std::vector<Summary> current = getSummaries();
+    for (std::size_t i = 0; i < current.size(); ++i) {
+        Comparison comparison;
+        comparison.current = current[i];
+        std::map<std::string, Summary>::iterator it =
+                previous.find(current[i].name);
+        if (it == previous.end()) {
+            comparison.verdict = added;
+            res.push_back(comparison);
+            continue;
+        }
+        const Summary& base = it->second;
+        const Summary& now = current[i];
+        comparison.baseline = base;
+        if (base.hasAccuracy && now.hasAccuracy &&
+                (worsened(now.rmse, base.rmse, accuracyTolerance_) ||
+                 worsened(now.maxDeviation, base.maxDeviation,
+                          accuracyTolerance_))) {
+            comparison.verdict = lessAccurate;
+        } else if (now.median > base.median * (1.0 + threshold_) &&
+                   now.low > base.high) {
+            comparison.verdict = slower;
+        } else if (now.median < base.median * (1.0 - threshold_) &&
+                   now.high < base.low) {
+            comparison.verdict = faster;
+        } else {
+            comparison.verdict = unchanged;
+        }
+        res.push_back(comparison);
+        previous.erase(it);
+    }
+    for (std::map<std::string, Summary>::const_iterator it =
+            previous.begin(); it != previous.end(); ++it) {
+        Comparison comparison;
+        comparison.baseline = it->second;
+        comparison.verdict = removed;
+        res.push_back(comparison);
+    }
+    return res;
+}
+
+Regression::Summary Regression::summarize(const std::string& name,
+                                          std::vector<double> times) {
+    Summary res;
+    res.name = name;
+    res.runs = times.size();
+    if (times.empty()) {
+        return res;
+    }
+    std::sort(times.begin(), times.end());
+    const std::size_t n = times.size();
+    res.median = (n % 2 == 1) ? times[n/2]
+                              : 0.5 * (times[n/2 - 1] + times[n/2]);
+    // Ranks, one-based, of the bounds; with ten runs or fewer they are the
+    // extremes.
+    const double spread = 0.5 * z95 * std::sqrt((double) n);
+    const long lower = (long) std::floor(0.5 * n - spread);
+    const long upper = (long) std::ceil(1.0 + 0.5 * n + spread);
+    res.low  = times[std::max(lower, 1L) - 1];
+    res.high = times[std::min(upper, (long) n) - 1];
+    return res;
+}
+
+std::vector<Regression::Summary> Regression::read(
+        const std::string& filename) {
+    std::ifstream file(filename.c_str());
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open " + filename);
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string text = buffer.str();
+
+    std::vector<Summary> res;
+    std::size_t pos = text.find('[');
+    if (pos == std::string::npos) {
+        throw std::runtime_error("No benchmarks in " + filename);
+    }
+    while ((pos = text.find('{', pos)) != std::string::npos) {
+        std::map<std::string, std::string> values = parseObject(text, pos);
+        Summary summary;
+        summary.name   = values["name"];
+        summary.runs   = (std::size_t) std::atol(values["runs"].c_str());
+        summary.median = std::atof(values["median"].c_str());
+        summary.low    = std::atof(values["low"].c_str());
+        summary.high   = std::atof(values["high"].c_str());
+        if (values.count("rmse") && values.count("maxDeviation")) {
+            summary.hasAccuracy = true;
+            summary.rmse = std::atof(values["rmse"].c_str());
+            summary.maxDeviation = std::atof(values["maxDeviation"].c_str());
+        }
+        if (summary.name.empty()) {
+            throw std::runtime_error("Unnamed benchmark in " + filename);
+        }
+        res.push_back(summary);
+        pos = text.find('}', pos);
+    }
+    return res;
+}
+
+void Regression::write(const std::string& filename,
+                       const std::vector<Summary>& summaries) {
+    std::ofstream file(filename.c_str());
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open " + filename);
+    }
+    file << std::setprecision(17);
+    file << "{" << std::endl << "  \"benchmarks\": [" << std::endl;
+    for (std::size_t i = 0; i < summaries.size(); ++i) {
+        const Summary& summary = summaries[i];
+        file << "    {\"name\": \"" << summary.name << "\""
+             << ", \"runs\": " << summary.runs
+             << ", \"median\": " << summary.median
+             << ", \"low\": " << summary.low
+             << ", \"high\": " << summary.high;
+        if (summary.hasAccuracy) {
+            file << ", \"rmse\": " << summary.rmse
+                 << ", \"maxDeviation\": " << summary.maxDeviation;
+        }
+        file << "}" << (i + 1 < summaries.size() ? "," : "") << std::endl;
+    }
+    file << "  ]" << std::endl << "}" << std::endl;
+}
+
+bool Regression::print(std::ostream& output,
+                       const std::vector<Comparison>& comparisons) {
+    std::size_t width = 9;
+    for (std::size_t i = 0; i < comparisons.size(); ++i) {
+        const Comparison& comparison = comparisons[i];
+        width = std::max(width, std::max(comparison.current.name.size(),
+                                         comparison.baseline.name.size()));
+    }
+    output << std::left << std::setw(width + 2) << "Benchmark"
+           << std::right << std::setw(14) << "Baseline"
+           << std::setw(14) << "Current"
+           << std::setw(10) << "Change"
+           << std::setw(14) << "RMSE"
+           << "  Verdict" << std::endl
+           << std::string(width + 2 + 14 + 14 + 10 + 14 + 15, '-')
+           << std::endl;
+    bool res = false;
+    for (std::size_t i = 0; i < comparisons.size(); ++i) {
+        const Comparison& comparison = comparisons[i];
+        const bool isBase = comparison.verdict != added;
+        const bool isCurrent = comparison.verdict != removed;
+        const Summary& named = isCurrent ? comparison.current
+                                         : comparison.baseline;
+        output << std::left << std::setw(width + 2) << named.name
+               << std::right << std::setw(14)
+               << (isBase ? formatTime(comparison.baseline.median) : "-")
+               << std::setw(14)
+               << (isCurrent ? formatTime(comparison.current.median) : "-");
+        if (isBase && isCurrent && comparison.baseline.median > 0.0) {
+            std::ostringstream change;
+            change << std::showpos << std::fixed << std::setprecision(1)
+                   << 100.0 * (comparison.current.median
+                             / comparison.baseline.median - 1.0) << "%";
+            output << std::setw(10) << change.str();
+        } else {
+            output << std::setw(10) << "-";
+        }
+        if (isCurrent && comparison.current.hasAccuracy) {
+            std::ostringstream rmse;
+            rmse << std::scientific << std::setprecision(3)
+                 << comparison.current.rmse;
+            output << std::setw(14) << rmse.str();
+        } else {
+            output << std::setw(14) << "-";
+        }
+        output << "  " << getVerdictName(comparison.verdict) << std::endl;
+        if (comparison.verdict == slower ||
+                comparison.verdict == lessAccurate) {
+            res = true;
+        }
+    }
+    return res;
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,117 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SEMBA_VECTOR_FITTING_REGRESSION_H_
+#define SEMBA_VECTOR_FITTING_REGRESSION_H_
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+namespace VectorFitting {
+
+/**
+ * Performance-regression check of the benchmark suite against a stored
+ * baseline. Each benchmark is summarized by the median of its repetitions
+ * and a distribution-free 95% confidence interval of that median, plus the
+ * "rmse" and "maxDeviation" counters when it reports them. A benchmark
+ * regresses when its median grows by more than the threshold and its
+ * interval no longer overlaps the baseline one, or when its accuracy
+ * worsens by more than the tolerance, whatever the timings.
+ *
+ * Baselines are only meaningful on the host they were recorded on.
+ */
+class Regression : public benchmark::BenchmarkReporter {
+public:
+    struct Summary {
+        std::string name;
+        std::size_t runs;
+        double median, low, high;  // Seconds per iteration.
+        bool hasAccuracy;
+        double rmse, maxDeviation;
+
+        Summary() : runs(0), median(0.0), low(0.0), high(0.0),
+                    hasAccuracy(false), rmse(0.0), maxDeviation(0.0) {}
+    };
+
+    enum Verdict {
+        unchanged,
+        faster,
+        slower,
+        lessAccurate,
+        added,
+        removed
+    };
+
+    struct Comparison {
+        Summary baseline, current;
+        Verdict verdict;
+    };
+
+    // Runs are forwarded to display, which is not owned and may be NULL.
+    explicit Regression(benchmark::BenchmarkReporter* display = NULL);
+
+    bool ReportContext(const Context& context);
+    void ReportRuns(const std::vector<Run>& reports);
+    void Finalize();
+
+    // Relative growth of the median that counts as a slowdown (5%).
+    void setThreshold(const double threshold) {threshold_ = threshold;}
+    // Relative growth of rmse or max deviation that fails (1%).
+    void setAccuracyTolerance(const double tolerance) {
+        accuracyTolerance_ = tolerance;
+    }
+
+    // Of the runs reported so far, sorted by name.
+    std::vector<Summary> getSummaries() const;
+
+    std::vector<Comparison> compare(
+            const std::vector<Summary>& baseline) const;
+
+    static Summary summarize(const std::string& name,
+                             std::vector<double> times);
+
+    static std::vector<Summary> read(const std::string& filename);
+    static void write(const std::string& filename,
+                      const std::vector<Summary>& summaries);
+
+    // Table of every comparison; returns whether any of them regressed.
+    static bool print(std::ostream& output,
+                      const std::vector<Comparison>& comparisons);
+
+private:
+    benchmark::BenchmarkReporter* display_;
+    double threshold_, accuracyTolerance_;
+
+    struct Measurements {
+        std::vector<double> times;
+        std::map<std::string, double> counters;
+    };
+    std::map<std::string, Measurements> measurements_;
+};
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_REGRESSION_H_ */
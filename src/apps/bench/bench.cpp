@@ -0,0 +1,316 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+// Benchmarks of the fitting kernels and of full fits. Run from the root of
+// the repository (datasets are read from testData/), e.g.
+//   build/bin/bench --benchmark_out=bench.json --benchmark_out_format=json
+// Kernel timings are those measured by fit() itself, see Statistics.h.
+//
+// Regression check against a stored baseline, see Regression.h:
+//   build/bin/bench --benchmark_repetitions=15 --write_baseline=FILE
+//   build/bin/bench --benchmark_repetitions=15 --baseline=FILE
+// The second run exits with an error when any benchmark regressed. Also
+// accepted are --regression_threshold=R (0.05) and --accuracy_tolerance=R
+// (0.01), both relative.
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "VectorFitting.h"
+#include "Cauchy.h"
+#include "Datasets.h"
+#include "Generator.h"
+#include "Regression.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace VectorFitting;
+using namespace std;
+
+namespace {
+
+vector<Sample> buildSynthetic(const size_t Ns, const size_t N,
+                              const size_t Nc) {
+    Generator generator;
+    generator.setSamplesSize(Ns);
+    generator.setOrder(N);
+    generator.setResponseSize(Nc);
+    return generator.getSamples();
+}
+
+enum DatasetId {ex1, ex2, paperSection4, fdne};
+
+Dataset buildDataset(const DatasetId dataset) {
+    switch (dataset) {
+    case ex1:
+        return Datasets::getEx1();
+    case ex2:
+        return Datasets::getEx2();
+    case paperSection4:
+        return Datasets::getPaperSection4();
+    case fdne:
+        return Datasets::read("testData/fdne.txt", 12);
+    }
+    return Dataset();
+}
+
+Options getOptions(const int64_t trend) {
+    Options res;
+    res.setAsymptoticTrend((Options::AsymptoticTrend) trend);
+    return res;
+}
+
+// Times a single kernel of fit(). Arguments: phase, Ns, N, Nc and trend.
+void BM_Kernel(benchmark::State& state) {
+    const Statistics::Phase phase = (Statistics::Phase) state.range(0);
+    const vector<Sample> samples = buildSynthetic(
+            state.range(1), state.range(2), state.range(3));
+    const vector<Complex> poles =
+            VectorFitting::VectorFitting::getStartingPoles(samples,
+                                                           state.range(2));
+    const Options opts = getOptions(state.range(4));
+    for (auto _ : state) {
+        VectorFitting::VectorFitting fitting(samples, poles, opts);
+        const Statistics statistics = fitting.fit();
+        state.SetIterationTime(statistics.seconds[phase]);
+    }
+#ifdef CompileWithoutStatistics
+    state.SkipWithError("Built with CompileWithoutStatistics");
+#endif
+    state.SetLabel(Statistics::getName(phase));
+}
+
+// Evaluation of a fitted model. Arguments: Ns, N, Nc and trend.
+void BM_FittedSamples(benchmark::State& state) {
+    const vector<Sample> samples = buildSynthetic(
+            state.range(0), state.range(1), state.range(2));
+    VectorFitting::VectorFitting fitting(samples, state.range(1),
+                                         getOptions(state.range(3)));
+    fitting.fit();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fitting.getFittedSamples());
+    }
+}
+
+void BM_RMSE(benchmark::State& state) {
+    const vector<Sample> samples = buildSynthetic(
+            state.range(0), state.range(1), state.range(2));
+    VectorFitting::VectorFitting fitting(samples, state.range(1),
+                                         getOptions(state.range(3)));
+    fitting.fit();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fitting.getRMSE());
+    }
+}
+
+// Products with the basis of a large model, dense or with the treecode of
+// Cauchy, setup included. Arguments: Ns, N and tolerance as 10^-k, zero
+// for dense.
+void BM_Cauchy(benchmark::State& state) {
+    const size_t Ns = state.range(0), N = state.range(1), Nc = 4;
+    const vector<Sample> samples = buildSynthetic(Ns, 10, 1);
+    const vector<Complex> poles =
+            VectorFitting::VectorFitting::getStartingPoles(samples, N);
+    VectorXcd frequencies(Ns);
+    for (size_t i = 0; i < Ns; ++i) {
+        frequencies(i) = samples[i].first;
+    }
+    const VectorXcd p = Eigen::Map<const VectorXcd>(poles.data(), N);
+    const MatrixXcd X = MatrixXcd::Random(N, Nc);
+    const Real tolerance = state.range(2) == 0 ?
+            0.0 : std::pow(10.0, - (Real) state.range(2));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+                Cauchy(frequencies, p, tolerance).multiply(X));
+    }
+}
+
+// A single call to fit() from the default starting poles. Arguments: Ns,
+// N, Nc and trend.
+void BM_Fit(benchmark::State& state) {
+    const vector<Sample> samples = buildSynthetic(
+            state.range(0), state.range(1), state.range(2));
+    const vector<Complex> poles =
+            VectorFitting::VectorFitting::getStartingPoles(samples,
+                                                           state.range(1));
+    const Options opts = getOptions(state.range(3));
+    for (auto _ : state) {
+        state.PauseTiming();
+        VectorFitting::VectorFitting fitting(samples, poles, opts);
+        state.ResumeTiming();
+        fitting.fit();
+    }
+}
+
+// Five iterations of fit() on each dataset of VectorFittingTest.
+void BM_Dataset(benchmark::State& state) {
+    const Dataset dataset = buildDataset((DatasetId) state.range(0));
+    const vector<Complex> poles =
+            VectorFitting::VectorFitting::getStartingPoles(dataset.samples,
+                                                           dataset.order);
+    Options opts;
+    opts.setAsymptoticTrend(dataset.trend);
+    Real rmse = 0.0, maxDeviation = 0.0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        VectorFitting::VectorFitting fitting(dataset.samples, poles, opts);
+        state.ResumeTiming();
+        for (size_t iter = 0; iter < 5; ++iter) {
+            fitting.fit();
+        }
+        state.PauseTiming();
+        rmse = fitting.getRMSE();
+        maxDeviation = fitting.getMaxDeviation();
+        state.ResumeTiming();
+    }
+    state.counters["rmse"] = rmse;
+    state.counters["maxDeviation"] = maxDeviation;
+    state.SetLabel(dataset.name);
+}
+
+const vector<int64_t> sizes    = {100, 1000};
+const vector<int64_t> orders   = {10, 30};
+const vector<int64_t> responses = {1, 16};
+const vector<int64_t> trends   = {Options::zero,
+                                  Options::constant,
+                                  Options::linear};
+
+} /* namespace */
+
+BENCHMARK(BM_Kernel)
+    ->ArgNames({"phase", "Ns", "N", "Nc", "trend"})
+    ->ArgsProduct({{Statistics::basis,
+                    Statistics::assembly,
+                    Statistics::solve,
+                    Statistics::eigen,
+                    Statistics::residues},
+                   sizes, orders, responses, trends})
+    ->UseManualTime()
+    // Each iteration is a whole fit; the shortest phases would otherwise
+    // need thousands of them to reach the minimum time.
+    ->Iterations(8)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(BM_FittedSamples)
+    ->ArgNames({"Ns", "N", "Nc", "trend"})
+    ->ArgsProduct({sizes, orders, responses, {Options::linear}})
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(BM_RMSE)
+    ->ArgNames({"Ns", "N", "Nc", "trend"})
+    ->ArgsProduct({sizes, orders, responses, {Options::linear}})
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(BM_Cauchy)
+    ->ArgNames({"Ns", "N", "tol"})
+    ->ArgsProduct({{10000}, {128, 256, 1024}, {0, 6, 10}})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_Fit)
+    ->ArgNames({"Ns", "N", "Nc", "trend"})
+    ->ArgsProduct({sizes, orders, responses, trends})
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_Dataset)
+    ->ArgNames({"dataset"})
+    ->DenseRange(ex1, fdne)
+    ->Unit(benchmark::kMillisecond);
+
+// Removes --name=value from the arguments, returns whether it was there.
+bool extractFlag(int& argc, char** argv, const char* name, string& value) {
+    const size_t length = strlen(name);
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], name, length) == 0 && argv[i][length] == '=') {
+            value = argv[i] + length + 1;
+            for (int j = i; j + 1 < argc; ++j) {
+                argv[j] = argv[j+1];
+            }
+            --argc;
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    string baseline, record, threshold, tolerance;
+    extractFlag(argc, argv, "--baseline", baseline);
+    extractFlag(argc, argv, "--write_baseline", record);
+    extractFlag(argc, argv, "--regression_threshold", threshold);
+    extractFlag(argc, argv, "--accuracy_tolerance", tolerance);
+#ifdef _OPENMP
+    benchmark::AddCustomContext("omp_threads",
+                                to_string(omp_get_max_threads()));
+#endif
+#ifdef CompileWithoutStatistics
+    benchmark::AddCustomContext("statistics", "disabled");
+#endif
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    if (baseline.empty() && record.empty()) {
+        benchmark::RunSpecifiedBenchmarks();
+        benchmark::Shutdown();
+        return 0;
+    }
+
+    benchmark::ConsoleReporter display;
+    Regression regression(&display);
+    if (!threshold.empty()) {
+        regression.setThreshold(atof(threshold.c_str()));
+    }
+    if (!tolerance.empty()) {
+        regression.setAccuracyTolerance(atof(tolerance.c_str()));
+    }
+    int res = 0;
+    try {
+        // Read first, a missing baseline should not cost a whole run.
+        vector<Regression::Summary> previous;
+        if (!baseline.empty()) {
+            previous = Regression::read(baseline);
+        }
+        benchmark::RunSpecifiedBenchmarks(&regression);
+        if (!record.empty()) {
+            Regression::write(record, regression.getSummaries());
+        }
+        if (!baseline.empty()) {
+            cout << endl;
+            if (Regression::print(cout, regression.compare(previous))) {
+                cerr << "Performance or accuracy regressed." << endl;
+                res = 2;
+            }
+        }
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        res = 1;
+    }
+    benchmark::Shutdown();
+    return res;
+}
@@ -0,0 +1,323 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+// Accuracy against cost of every solver configuration on a corpus of
+// datasets. Each configuration fits each dataset from the default starting
+// poles; wall time is the median over the repetitions of building the
+// fitter and running all its iterations, peak memory the highest heap
+// growth over the same span. Configurations that no other one beats both
+// in time and in RMSE form the Pareto front of the dataset.
+//
+// Run from the root of the repository, datasets are read from testData/.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Allocation.h"
+#include "Datasets.h"
+#include "VectorFitting.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+namespace {
+
+struct Arguments {
+    vector<string> inputs;
+    string output;
+    size_t order = 12;
+    Options::AsymptoticTrend trend = Options::constant;
+    size_t iterations = 5;
+    size_t repetitions = 3;
+    size_t syntheticSize = 5000;
+    bool builtin = true;
+};
+
+// A solver of Options or, when adaptive, the default SolverPolicy.
+struct Configuration {
+    string name;
+    Options::Solver solver = Options::householder;
+    bool adaptive = false;
+};
+
+struct Measurement {
+    string status = "ok";
+    double seconds = 0.0;
+    size_t peakBytes = 0;
+    Real rmse = 0.0, maxDeviation = 0.0;
+    bool pareto = false;
+};
+
+void printUsage() {
+    cout << "Usage: pareto [options] [file...]" << endl
+         << "Fits a corpus with every solver configuration and reports the"
+         << endl
+         << "time against accuracy Pareto front of each dataset." << endl
+         << endl
+         << "  -o, --output FILE         Tab separated results (none)."
+         << endl
+         << "      --order N             Order of the input files (12)."
+         << endl
+         << "      --trend T             zero | constant | linear,"
+         << " of the input files" << endl
+         << "                            (constant)." << endl
+         << "  -n, --iterations N        Relocation iterations (5)." << endl
+         << "  -r, --repetitions N       Timed runs of each fit (3)." << endl
+         << "      --synthetic-size N    Samples of the synthetic dataset"
+         << " (5000)." << endl
+         << "      --no-builtin          Only the input files, without the"
+         << endl
+         << "                            reference, fdne and synthetic sets."
+         << endl
+         << "  -h, --help                Shows this message." << endl;
+}
+
+size_t toSize(const string& value) {
+    char* end;
+    const long res = strtol(value.c_str(), &end, 10);
+    if (*end != '\0' || res < 0) {
+        throw runtime_error("Invalid number: " + value);
+    }
+    return (size_t) res;
+}
+
+Arguments parse(int argc, char** argv) {
+    Arguments args;
+    for (int i = 1; i < argc; ++i) {
+        const string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            exit(EXIT_SUCCESS);
+        }
+        if (arg.empty() || arg[0] != '-') {
+            args.inputs.push_back(arg);
+            continue;
+        }
+        if (arg == "--no-builtin") {
+            args.builtin = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            throw runtime_error("Missing value for " + arg);
+        }
+        const string value = argv[++i];
+        if (arg == "-o" || arg == "--output") {
+            args.output = value;
+        } else if (arg == "--order") {
+            args.order = toSize(value);
+        } else if (arg == "--trend") {
+            if      (value == "zero"    ) args.trend = Options::zero;
+            else if (value == "constant") args.trend = Options::constant;
+            else if (value == "linear"  ) args.trend = Options::linear;
+            else throw runtime_error("Unknown trend: " + value);
+        } else if (arg == "-n" || arg == "--iterations") {
+            args.iterations = toSize(value);
+        } else if (arg == "-r" || arg == "--repetitions") {
+            args.repetitions = max<size_t>(toSize(value), 1);
+        } else if (arg == "--synthetic-size") {
+            args.syntheticSize = toSize(value);
+        } else {
+            throw runtime_error("Unknown option: " + arg);
+        }
+    }
+    if (!args.builtin && args.inputs.empty()) {
+        throw runtime_error("No datasets");
+    }
+    return args;
+}
+
+vector<Configuration> getConfigurations() {
+    vector<Configuration> res(4);
+    res[0].name = "qr";
+    res[0].solver = Options::householder;
+    res[1].name = "normal";
+    res[1].solver = Options::normalEquations;
+    res[2].name = "pivoting";
+    res[2].solver = Options::columnPivoting;
+    res[3].name = "adaptive";
+    res[3].solver = Options::householder;
+    res[3].adaptive = true;
+    return res;
+}
+
+vector<Dataset> getCorpus(const Arguments& args) {
+    vector<Dataset> res;
+    if (args.builtin) {
+        res = Datasets::getReferences();
+        res.push_back(Datasets::read("testData/fdne.txt", 12));
+        Generator generator;
+        generator.setSamplesSize(args.syntheticSize);
+        generator.setResponseSize(8);
+        generator.setOrder(20);
+        generator.setConditioning(1e3);
+        generator.setNoise(1e-4);
+        generator.setClustering(0.3, 0.05);
+        res.push_back(Datasets::generate(generator));
+    }
+    for (size_t i = 0; i < args.inputs.size(); ++i) {
+        res.push_back(Datasets::read(args.inputs[i], args.order, args.trend));
+    }
+    return res;
+}
+
+Measurement measure(const Dataset& dataset,
+                    const Configuration& configuration,
+                    const Arguments& args) {
+    Options opts;
+    opts.setAsymptoticTrend(dataset.trend);
+    opts.setSolver(configuration.solver);
+    const vector<Complex> poles =
+            VectorFitting::VectorFitting::getStartingPoles(dataset.samples,
+                                                           dataset.order);
+    Measurement res;
+    vector<double> seconds;
+    try {
+        for (size_t r = 0; r < args.repetitions; ++r) {
+            const size_t baseline = Allocation::getCurrent();
+            const Allocation::Peak peak;
+            const chrono::steady_clock::time_point start =
+                    chrono::steady_clock::now();
+            VectorFitting::VectorFitting fitting(dataset.samples, poles, opts);
+            if (configuration.adaptive) {
+                fitting.setSolverPolicy(
+                        VectorFitting::VectorFitting::getAdaptiveSolver);
+            }
+            for (size_t iter = 0; iter < args.iterations; ++iter) {
+                fitting.fit();
+            }
+            seconds.push_back(chrono::duration<double>(
+                    chrono::steady_clock::now() - start).count());
+            if (peak.get() > baseline) {
+                res.peakBytes = max(res.peakBytes, peak.get() - baseline);
+            }
+            res.rmse = fitting.getRMSE();
+            res.maxDeviation = fitting.getMaxDeviation();
+        }
+    } catch (const exception& e) {
+        res.status = e.what();
+        return res;
+    }
+    sort(seconds.begin(), seconds.end());
+    res.seconds = seconds[seconds.size() / 2];
+    return res;
+}
+
+bool isValid(const Measurement& m) {
+    return m.status == "ok" && std::isfinite(m.rmse);
+}
+
+// Front of the configurations that fitted, by time and RMSE.
+void markPareto(vector<Measurement>& measurements) {
+    for (size_t i = 0; i < measurements.size(); ++i) {
+        Measurement& a = measurements[i];
+        a.pareto = isValid(a);
+        for (size_t j = 0; j < measurements.size() && a.pareto; ++j) {
+            const Measurement& b = measurements[j];
+            if (j == i || !isValid(b)) {
+                continue;
+            }
+            if (b.seconds <= a.seconds && b.rmse <= a.rmse &&
+                    (b.seconds < a.seconds || b.rmse < a.rmse)) {
+                a.pareto = false;
+            }
+        }
+    }
+}
+
+} /* namespace */
+
+int main(int argc, char** argv) {
+    Arguments args;
+    vector<Dataset> corpus;
+    try {
+        args = parse(argc, argv);
+        corpus = getCorpus(args);
+    } catch (const exception& e) {
+        cerr << "pareto: " << e.what() << endl;
+        printUsage();
+        return EXIT_FAILURE;
+    }
+    if (!Allocation::isTracking()) {
+        cerr << "pareto: built without allocation tracking,"
+             << " peak memory will read zero" << endl;
+    }
+
+    ofstream file;
+    if (!args.output.empty()) {
+        file.open(args.output.c_str());
+        if (!file.is_open()) {
+            cerr << "pareto: unable to open " << args.output << endl;
+            return EXIT_FAILURE;
+        }
+        file << "# dataset\tNs\tNc\tN\tconfiguration\tseconds\tpeakBytes"
+             << "\trmse\tmaxDeviation\tpareto\tstatus" << endl;
+    }
+
+    const vector<Configuration> configurations = getConfigurations();
+    for (size_t d = 0; d < corpus.size(); ++d) {
+        const Dataset& dataset = corpus[d];
+        const size_t Ns = dataset.samples.size();
+        const size_t Nc = Ns == 0 ? 0 : dataset.samples.front().second.size();
+        vector<Measurement> measurements;
+        for (size_t c = 0; c < configurations.size(); ++c) {
+            measurements.push_back(measure(dataset, configurations[c], args));
+        }
+        markPareto(measurements);
+
+        cout << dataset.name << ": Ns " << Ns << ", Nc " << Nc
+             << ", N " << dataset.order << endl;
+        cout << "  " << left << setw(20) << "configuration" << right
+             << setw(12) << "ms" << setw(12) << "peak KiB"
+             << setw(12) << "rmse" << setw(12) << "max dev" << endl;
+        for (size_t c = 0; c < configurations.size(); ++c) {
+            const Measurement& m = measurements[c];
+            cout << (m.pareto ? "* " : "  ") << left << setw(20)
+                 << configurations[c].name << right;
+            if (m.status == "ok") {
+                cout << fixed << setprecision(3)
+                     << setw(12) << m.seconds * 1e3
+                     << setw(12) << m.peakBytes / 1024
+                     << scientific << setprecision(2)
+                     << setw(12) << m.rmse << setw(12) << m.maxDeviation;
+            } else {
+                cout << "  " << m.status;
+            }
+            cout << defaultfloat << endl;
+            if (file.is_open()) {
+                file << dataset.name << "\t" << Ns << "\t" << Nc << "\t"
+                     << dataset.order << "\t" << configurations[c].name
+                     << "\t" << m.seconds << "\t" << m.peakBytes
+                     << "\t" << m.rmse << "\t" << m.maxDeviation
+                     << "\t" << m.pareto << "\t" << m.status << endl;
+            }
+        }
+        cout << endl;
+    }
+    return EXIT_SUCCESS;
+}
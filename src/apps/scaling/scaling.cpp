@@ -0,0 +1,763 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+// Thread scaling of the parallel paths of the library:
+//  - qr:       per response systems of pole identification, the assembly
+//              phase of fit(), TSQR merges included. The sample store is
+//              filled by the main thread, the worst first-touch placement.
+//  - qr-local: the same with the store filled by the team that fits it,
+//              each block of responses on the node of its thread.
+//  - tsqr:     the parallel reduction of per response factors alone.
+//  - batch:    BatchFitter over independent data sets.
+//  - evaluate: getFittedSamples(), serial today, as reference.
+// Each one runs at 1, 2, 4 ... threads, unpinned and pinned. Pinned threads
+// fill a NUMA node before using the next one (compact) or alternate among
+// nodes (spread). Binding is left to the OpenMP runtime: as OMP_PLACES and
+// OMP_PROC_BIND are only read at startup, each placement runs in its own
+// process with one place per allowed cpu, in node order, and OMP_PROC_BIND
+// set to close or spread; the parallel regions of this tool ask for the
+// same policy through proc_bind. Bandwidth is the data each kernel must at
+// least move divided by its time; the triad column is what a STREAM triad
+// reaches with the same threads and placement, their ratio tells how close
+// to bandwidth-bound the kernel is.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BatchFitter.h"
+#include "Generator.h"
+#include "Reducer.h"
+#include "SampleSet.h"
+#include "Tuning.h"
+#include "VectorFitting.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef __linux__
+#include <sched.h>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
+#endif
+
+using namespace VectorFitting;
+using namespace std;
+
+namespace {
+
+struct Arguments {
+    vector<string> kernels;
+    string output;
+    size_t Ns = 2000, N = 20, Nc = 64;
+    size_t jobs = 32;
+    size_t repetitions = 3;
+    size_t maxThreads = 0;
+    size_t nodes = 0;
+    bool pinning = true;
+    // Set on the processes running a single placement.
+    bool child = false;
+    int placement = 0;
+};
+
+enum Placement {
+    unpinned,
+    compact,
+    spread,
+    numberOfPlacements
+};
+
+const char* getPlacementName(const Placement placement) {
+    switch (placement) {
+    case unpinned:
+        return "unpinned";
+    case compact:
+        return "compact";
+    case spread:
+        return "spread";
+    default:
+        return "";
+    }
+}
+
+// Cpus this process may run on, grouped by NUMA node.
+typedef vector<vector<int>> Topology;
+
+struct Measurement {
+    double seconds;
+    double bytes;       // Least traffic of the kernel.
+};
+
+void printUsage() {
+    cout << "Usage: scaling [options]" << endl
+         << "Speedup, efficiency and bandwidth of the parallel paths at"
+         << endl
+         << "increasing thread counts and thread placements." << endl
+         << endl
+         << "  -k, --kernel K            qr | qr-local | tsqr | batch |"
+         << endl
+         << "                            evaluate, may be repeated (all)."
+         << endl
+         << "  -o, --output FILE         Tab separated results (none)."
+         << endl
+         << "      --samples N           Samples of each data set (2000)."
+         << endl
+         << "      --order N             Poles of each fit (20)." << endl
+         << "      --responses N         Responses of each data set (64)."
+         << endl
+         << "      --jobs N              Data sets of the batch (32)." << endl
+         << "  -r, --repetitions N       Timed runs, the median is kept (3)."
+         << endl
+         << "  -t, --max-threads N       Highest thread count, 0 for all"
+         << " cpus (0)." << endl
+         << "      --nodes N             NUMA nodes to use, 0 for all (0)."
+         << endl
+         << "      --no-pinning          Only unpinned runs, as bound by the"
+         << endl
+         << "                            environment." << endl
+         << "  -h, --help                Shows this message." << endl;
+}
+
+size_t toSize(const string& value) {
+    char* end;
+    const long res = strtol(value.c_str(), &end, 10);
+    if (*end != '\0' || res < 0) {
+        throw runtime_error("Invalid number: " + value);
+    }
+    return (size_t) res;
+}
+
+Arguments parse(int argc, char** argv) {
+    Arguments args;
+    for (int i = 1; i < argc; ++i) {
+        const string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            exit(EXIT_SUCCESS);
+        }
+        if (arg == "--no-pinning") {
+            args.pinning = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            throw runtime_error("Missing value for " + arg);
+        }
+        const string value = argv[++i];
+        if (arg == "-k" || arg == "--kernel") {
+            if (value != "qr" && value != "qr-local" && value != "tsqr" &&
+                    value != "batch" && value != "evaluate") {
+                throw runtime_error("Unknown kernel: " + value);
+            }
+            args.kernels.push_back(value);
+        } else if (arg == "-o" || arg == "--output") {
+            args.output = value;
+        } else if (arg == "--samples") {
+            args.Ns = max<size_t>(toSize(value), 1);
+        } else if (arg == "--order") {
+            args.N = toSize(value);
+        } else if (arg == "--responses") {
+            args.Nc = max<size_t>(toSize(value), 1);
+        } else if (arg == "--jobs") {
+            args.jobs = max<size_t>(toSize(value), 1);
+        } else if (arg == "-r" || arg == "--repetitions") {
+            args.repetitions = max<size_t>(toSize(value), 1);
+        } else if (arg == "-t" || arg == "--max-threads") {
+            args.maxThreads = toSize(value);
+        } else if (arg == "--nodes") {
+            args.nodes = toSize(value);
+        } else if (arg == "--placement") {
+            // Internal, see spawn().
+            args.child = true;
+            args.placement = (int) toSize(value);
+            if (args.placement >= numberOfPlacements) {
+                throw runtime_error("Unknown placement: " + value);
+            }
+        } else {
+            throw runtime_error("Unknown option: " + arg);
+        }
+    }
+    if (args.N % 2 != 0) {
+        throw runtime_error("Default starting poles are complex,"
+                            " order must be even");
+    }
+    if (args.kernels.empty()) {
+        args.kernels.push_back("qr");
+        args.kernels.push_back("qr-local");
+        args.kernels.push_back("tsqr");
+        args.kernels.push_back("batch");
+        args.kernels.push_back("evaluate");
+    }
+    return args;
+}
+
+vector<int> parseCpuList(const string& list) {
+    vector<int> res;
+    stringstream input(list);
+    string range;
+    while (getline(input, range, ',')) {
+        const size_t dash = range.find('-');
+        const int first = atoi(range.substr(0, dash).c_str());
+        const int last = dash == string::npos ?
+                first : atoi(range.substr(dash + 1).c_str());
+        for (int cpu = first; cpu <= last; ++cpu) {
+            res.push_back(cpu);
+        }
+    }
+    return res;
+}
+
+Topology getTopology() {
+    vector<int> allowed;
+#ifdef _OPENMP
+    // A bound runtime may have pinned this thread to its first place
+    // already, the places are what the team may run on.
+    if (omp_get_proc_bind() != omp_proc_bind_false) {
+        for (int place = 0; place < omp_get_num_places(); ++place) {
+            vector<int> cpus(omp_get_place_num_procs(place));
+            if (!cpus.empty()) {
+                omp_get_place_proc_ids(place, &cpus[0]);
+                allowed.insert(allowed.end(), cpus.begin(), cpus.end());
+            }
+        }
+        sort(allowed.begin(), allowed.end());
+        allowed.erase(unique(allowed.begin(), allowed.end()), allowed.end());
+    }
+#endif
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (allowed.empty() && sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                allowed.push_back(cpu);
+            }
+        }
+    }
+#endif
+    Topology res;
+    for (size_t node = 0; !allowed.empty(); ++node) {
+        ifstream file(("/sys/devices/system/node/node" +
+                       to_string(node) + "/cpulist").c_str());
+        if (!file.is_open()) {
+            break;
+        }
+        string list;
+        getline(file, list);
+        vector<int> cpus;
+        const vector<int> nodeCpus = parseCpuList(list);
+        for (size_t i = 0; i < nodeCpus.size(); ++i) {
+            if (find(allowed.begin(), allowed.end(), nodeCpus[i]) !=
+                    allowed.end()) {
+                cpus.push_back(nodeCpus[i]);
+            }
+        }
+        if (!cpus.empty()) {
+            res.push_back(cpus);
+        }
+    }
+    if (res.empty()) {
+        // No affinity or no sysfs, a single node without pinning.
+        res.push_back(allowed);
+    }
+    return res;
+}
+
+size_t getMaxThreads() {
+#ifdef _OPENMP
+    return (size_t) omp_get_num_procs();
+#else
+    return 1;
+#endif
+}
+
+// One place per cpu, filling each node before the next one.
+string getPlaces(const Topology& topology) {
+    string res;
+    for (size_t n = 0; n < topology.size(); ++n) {
+        for (size_t i = 0; i < topology[n].size(); ++i) {
+            res += (res.empty() ? "{" : ",{") + to_string(topology[n][i]) +
+                   "}";
+        }
+    }
+    return res;
+}
+
+// Runs body on a team of threads bound as the placement says. Worksharing
+// constructs of body bind to this team.
+template<typename Body>
+void runTeam(const Placement placement, const size_t threads,
+             const Body& body) {
+    switch (placement) {
+    case compact:
+#pragma omp parallel num_threads((int) threads) proc_bind(close)
+        body();
+        break;
+    case spread:
+#pragma omp parallel num_threads((int) threads) proc_bind(spread)
+        body();
+        break;
+    default:
+#pragma omp parallel num_threads((int) threads)
+        body();
+        break;
+    }
+}
+
+// NUMA nodes the threads of a team run on, all of them when not bound.
+size_t countNodes(const Topology& topology, const Placement placement,
+                  const size_t threads) {
+    vector<int> used(topology.size(), 0);
+    bool bound = true;
+#ifdef _OPENMP
+    runTeam(placement, threads, [&]() {
+        const int place = omp_get_place_num();
+        if (place < 0 || omp_get_place_num_procs(place) == 0) {
+#pragma omp atomic write
+            bound = false;
+            return;
+        }
+        vector<int> cpus(omp_get_place_num_procs(place));
+        omp_get_place_proc_ids(place, &cpus[0]);
+        for (size_t n = 0; n < topology.size(); ++n) {
+            if (find(topology[n].begin(), topology[n].end(), cpus[0]) !=
+                    topology[n].end()) {
+#pragma omp atomic write
+                used[n] = 1;
+            }
+        }
+    });
+#else
+    (void) placement;
+    (void) threads;
+    bound = false;
+#endif
+    if (!bound) {
+        return topology.size();
+    }
+    return (size_t) count(used.begin(), used.end(), 1);
+}
+
+double getSeconds(const chrono::steady_clock::time_point& start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+            .count();
+}
+
+vector<Sample> buildSamples(const size_t Ns, const size_t N,
+                            const size_t Nc, const size_t seed = 0) {
+    Generator generator(seed);
+    generator.setSamplesSize(Ns);
+    generator.setOrder(N);
+    generator.setResponseSize(Nc);
+    return generator.getSamples();
+}
+
+// Bytes of the per response systems: Dk and the data read, the system
+// written once and read back by its factorization.
+double getSystemBytes(const size_t Ns, const size_t N, const size_t Nc) {
+    const double dk = (double) Ns * (N + 2) * 2 * sizeof(Real);
+    const double data = (double) Ns * 3 * sizeof(Real);
+    const double system = (double) (2*Ns + 1) * (2*N + 2) * sizeof(Real);
+    return Nc * (dk + data + 2.0 * system);
+}
+
+// The sample store is filled by threads of the fit when local, else by the
+// calling thread.
+Measurement runQR(const Arguments& args, const vector<Sample>& samples,
+                  const vector<Complex>& poles, const size_t threads,
+                  const bool local) {
+    Options opts;
+    Measurement res;
+    const shared_ptr<const SampleSet> data = SampleSet::build(
+            samples, vector<vector<Real>>(), local ? threads : 1);
+    VectorFitting::VectorFitting fitting(data, poles, opts);
+    const Statistics statistics = fitting.fit();
+    res.seconds = statistics.seconds[Statistics::assembly];
+    res.bytes = getSystemBytes(args.Ns, args.N, args.Nc);
+    return res;
+}
+
+Measurement runTSQR(const Arguments& args,
+                    const vector<Eigen::MatrixXd>& R,
+                    const vector<Eigen::VectorXd>& b,
+                    const Placement placement, const size_t threads) {
+    const size_t K = args.N + 1;
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    Eigen::MatrixXd AA(0, K);
+    Eigen::VectorXd bb(0);
+    // Same reduction as fit().
+    runTeam(placement, threads, [&]() {
+        Eigen::MatrixXd localAA(0, K);
+        Eigen::VectorXd localbb(0);
+#pragma omp for schedule(static) nowait
+        for (long n = 0; n < (long) R.size(); ++n) {
+            Reducer::merge(localAA, localbb, R[n], b[n]);
+        }
+#pragma omp critical
+        Reducer::merge(AA, bb, localAA, localbb);
+    });
+    Measurement res;
+    res.seconds = getSeconds(start);
+    res.bytes = (double) R.size() * (K*K + K) * sizeof(Real);
+    return res;
+}
+
+Measurement runBatch(const Arguments& args,
+                     const vector<vector<Sample>>& batch,
+                     const size_t threads) {
+    BatchFitter fitter;
+    fitter.setOrders(args.N, args.N);
+    fitter.setIterations(3);
+    fitter.setThreads(threads);
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    fitter.fit(batch);
+    Measurement res;
+    res.seconds = getSeconds(start);
+    const size_t Nc = batch.front().front().second.size();
+    res.bytes = 3.0 * batch.size() * getSystemBytes(args.Ns, args.N, Nc);
+    return res;
+}
+
+Measurement runEvaluate(const Arguments& args,
+                        const VectorFitting::VectorFitting& fitting) {
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    const vector<Sample> fitted = fitting.getFittedSamples();
+    Measurement res;
+    res.seconds = getSeconds(start);
+    res.bytes = (double) args.Ns * (2*args.N + 2*args.Nc) * sizeof(Complex);
+    return res;
+}
+
+// Bytes per second of a = b + s c, arrays first touched by the same threads.
+double getTriadBandwidth(const Placement placement, const size_t threads) {
+    const long size = 1L << 23;
+    // Left untouched, the team places every page.
+    unique_ptr<double[]> a(new double[size]);
+    unique_ptr<double[]> b(new double[size]);
+    unique_ptr<double[]> c(new double[size]);
+    runTeam(placement, threads, [&]() {
+#pragma omp for schedule(static)
+        for (long i = 0; i < size; ++i) {
+            a[i] = 0.0;
+            b[i] = 1.0;
+            c[i] = 2.0;
+        }
+    });
+    double best = 0.0;
+    for (size_t r = 0; r < 5; ++r) {
+        const chrono::steady_clock::time_point start =
+                chrono::steady_clock::now();
+        runTeam(placement, threads, [&]() {
+#pragma omp for schedule(static)
+            for (long i = 0; i < size; ++i) {
+                a[i] = b[i] + 3.0 * c[i];
+            }
+        });
+        best = max(best, 3.0 * size * sizeof(double) / getSeconds(start));
+    }
+    return best;
+}
+
+double getMedian(vector<double> values) {
+    sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+// Times every kernel at every thread count with one placement, appending
+// rows to the output file when given.
+int run(const Arguments& args, const Topology& topology,
+        const Placement placement, const vector<size_t>& threadCounts) {
+    // Inputs are built once, by the main thread.
+    const vector<Sample> samples = buildSamples(args.Ns, args.N, args.Nc);
+    const vector<Complex> poles =
+            VectorFitting::VectorFitting::getStartingPoles(samples, args.N);
+    VectorFitting::VectorFitting fitted(samples, poles, Options());
+    fitted.fit();
+    vector<Eigen::MatrixXd> R(args.Nc * 64);
+    vector<Eigen::VectorXd> b(R.size());
+    for (size_t n = 0; n < R.size(); ++n) {
+        R[n] = Eigen::MatrixXd::Random(args.N + 1, args.N + 1)
+                .triangularView<Eigen::Upper>();
+        b[n] = Eigen::VectorXd::Random(args.N + 1);
+    }
+    vector<vector<Sample>> batch(args.jobs);
+    for (size_t j = 0; j < args.jobs; ++j) {
+        batch[j] = buildSamples(args.Ns, args.N, 4, j + 1);
+    }
+
+    ofstream file;
+    if (!args.output.empty()) {
+        file.open(args.output.c_str(), ios::app);
+        if (!file.is_open()) {
+            cerr << "scaling: unable to open " << args.output << endl;
+            return EXIT_FAILURE;
+        }
+    }
+    cout << left << setw(10) << "kernel" << setw(10) << "placement"
+         << right << setw(8) << "threads" << setw(6) << "nodes"
+         << setw(12) << "ms" << setw(9) << "speedup" << setw(11)
+         << "efficiency" << setw(10) << "GB/s" << setw(10) << "triad"
+         << endl;
+
+    // Medians of the qr kernels, by thread count.
+    vector<double> remote, local;
+    for (size_t k = 0; k < args.kernels.size(); ++k) {
+        const string& kernel = args.kernels[k];
+        double serial = 0.0;
+        for (size_t c = 0; c < threadCounts.size(); ++c) {
+            const size_t threads = threadCounts[c];
+#ifdef _OPENMP
+            omp_set_num_threads((int) threads);
+#endif
+            const size_t nodes = countNodes(topology, placement, threads);
+            const double triad = getTriadBandwidth(placement, threads);
+
+            vector<double> seconds;
+            double bytes = 0.0;
+            for (size_t r = 0; r < args.repetitions; ++r) {
+                Measurement m;
+                if (kernel == "qr" || kernel == "qr-local") {
+                    m = runQR(args, samples, poles, threads,
+                              kernel == "qr-local");
+                } else if (kernel == "tsqr") {
+                    m = runTSQR(args, R, b, placement, threads);
+                } else if (kernel == "batch") {
+                    m = runBatch(args, batch, threads);
+                } else {
+                    m = runEvaluate(args, fitted);
+                }
+                seconds.push_back(m.seconds);
+                bytes = m.bytes;
+            }
+            const double median = getMedian(seconds);
+            if (kernel == "qr") {
+                remote.push_back(median);
+            } else if (kernel == "qr-local") {
+                local.push_back(median);
+            }
+            // Speedups of every placement are relative to its own single
+            // thread run.
+            if (threads == 1) {
+                serial = median;
+            }
+            const double speedup = serial > 0.0 ? serial / median : 0.0;
+            const double efficiency = speedup / (double) threads;
+            const double bandwidth = bytes / median;
+
+            cout << left << setw(10) << kernel
+                 << setw(10) << getPlacementName(placement)
+                 << right << setw(8) << threads << setw(6) << nodes
+                 << fixed << setprecision(3) << setw(12) << median * 1e3
+                 << setprecision(2) << setw(9) << speedup
+                 << setw(11) << efficiency
+                 << setw(10) << bandwidth * 1e-9
+                 << setw(10) << triad * 1e-9 << defaultfloat << endl;
+            if (file.is_open()) {
+                file << kernel << "\t" << getPlacementName(placement) << "\t"
+                     << threads << "\t" << nodes << "\t"
+                     << median << "\t" << speedup << "\t" << efficiency
+                     << "\t" << bandwidth << "\t" << triad << endl;
+            }
+        }
+        cout << endl;
+    }
+
+    if (!remote.empty() && !local.empty()) {
+        // What filling the store from the fitting team saves.
+        cout << "First touch, " << getPlacementName(placement) << ":" << endl
+             << right << setw(8) << "threads" << setw(12) << "qr ms"
+             << setw(14) << "qr-local ms" << setw(9) << "gain" << endl;
+        for (size_t c = 0; c < threadCounts.size(); ++c) {
+            cout << setw(8) << threadCounts[c]
+                 << fixed << setprecision(3) << setw(12) << remote[c] * 1e3
+                 << setw(14) << local[c] * 1e3
+                 << setprecision(2) << setw(9) << remote[c] / local[c]
+                 << defaultfloat << endl;
+        }
+        cout << endl;
+    }
+    return EXIT_SUCCESS;
+}
+
+#ifdef __linux__
+// Runs one placement in a new process of this program, with the binding of
+// its threads set in the environment the OpenMP runtime starts from.
+int spawn(int argc, char** argv, const Topology& topology,
+          const Placement placement, const size_t maxThreads) {
+    vector<string> environment;
+    for (char** var = environ; *var != NULL; ++var) {
+        const string value = *var;
+        if (value.compare(0, 11, "OMP_PLACES=") != 0 &&
+                value.compare(0, 14, "OMP_PROC_BIND=") != 0) {
+            environment.push_back(value);
+        }
+    }
+    if (placement == unpinned) {
+        environment.push_back("OMP_PROC_BIND=false");
+    } else {
+        environment.push_back("OMP_PLACES=" + getPlaces(topology));
+        environment.push_back(string("OMP_PROC_BIND=") +
+                              (placement == compact ? "close" : "spread"));
+    }
+    vector<string> arguments(argv, argv + argc);
+    // The cpus of the child may be narrowed to its first place.
+    arguments.push_back("--max-threads");
+    arguments.push_back(to_string(maxThreads));
+    arguments.push_back("--placement");
+    arguments.push_back(to_string((int) placement));
+
+    vector<char*> envp, args;
+    for (size_t i = 0; i < environment.size(); ++i) {
+        envp.push_back(&environment[i][0]);
+    }
+    envp.push_back(NULL);
+    for (size_t i = 0; i < arguments.size(); ++i) {
+        args.push_back(&arguments[i][0]);
+    }
+    args.push_back(NULL);
+
+    cout.flush();
+    pid_t pid;
+    if (posix_spawn(&pid, "/proc/self/exe", NULL, NULL, &args[0],
+                    &envp[0]) != 0) {
+        cerr << "scaling: unable to run the " << getPlacementName(placement)
+             << " placement" << endl;
+        return EXIT_FAILURE;
+    }
+    int status = 0;
+    if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) {
+        return EXIT_FAILURE;
+    }
+    return WEXITSTATUS(status);
+}
+
+// Whether the runtime of this process binds threads as the placement says.
+bool isBound(const Topology& topology, const Placement placement) {
+#ifdef _OPENMP
+    size_t cpus = 0;
+    for (size_t n = 0; n < topology.size(); ++n) {
+        cpus += topology[n].size();
+    }
+    // One place per cpu, see getPlaces().
+    switch (placement) {
+    case compact:
+        return omp_get_proc_bind() == omp_proc_bind_close &&
+               (size_t) omp_get_num_places() == cpus;
+    case spread:
+        return omp_get_proc_bind() == omp_proc_bind_spread &&
+               (size_t) omp_get_num_places() == cpus;
+    default:
+        return omp_get_proc_bind() == omp_proc_bind_false;
+    }
+#else
+    (void) topology;
+    return placement == unpinned;
+#endif
+}
+#endif
+
+} /* namespace */
+
+int main(int argc, char** argv) {
+    Arguments args;
+    try {
+        args = parse(argc, argv);
+    } catch (const exception& e) {
+        cerr << "scaling: " << e.what() << endl;
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    // Thread counts are set here, not taken from a tuning profile.
+    Tuning::set(Tuning());
+
+    Topology topology = getTopology();
+    if (args.nodes != 0 && args.nodes < topology.size()) {
+        topology.resize(args.nodes);
+    }
+    vector<int> allowed;
+    for (size_t n = 0; n < topology.size(); ++n) {
+        allowed.insert(allowed.end(), topology[n].begin(), topology[n].end());
+    }
+    size_t maxThreads = args.maxThreads == 0 ? getMaxThreads()
+                                             : args.maxThreads;
+    if (args.nodes != 0 && !allowed.empty()) {
+        maxThreads = min(maxThreads, allowed.size());
+    }
+    vector<size_t> threadCounts;
+    for (size_t t = 1; t < maxThreads; t *= 2) {
+        threadCounts.push_back(t);
+    }
+    threadCounts.push_back(maxThreads);
+
+#ifdef __linux__
+    if (args.child) {
+        const Placement placement = (Placement) args.placement;
+        if (!isBound(topology, placement)) {
+            cerr << "scaling: the OpenMP runtime does not bind threads "
+                 << getPlacementName(placement) << endl;
+            return EXIT_FAILURE;
+        }
+        return run(args, topology, placement, threadCounts);
+    }
+#endif
+
+    cout << "NUMA nodes: " << topology.size() << ", cpus: " << allowed.size()
+         << ", Ns " << args.Ns << ", N " << args.N << ", Nc " << args.Nc
+         << endl << endl;
+    if (!args.output.empty()) {
+        ofstream file(args.output.c_str());
+        if (!file.is_open()) {
+            cerr << "scaling: unable to open " << args.output << endl;
+            return EXIT_FAILURE;
+        }
+        file << "# kernel\tplacement\tthreads\tnodes\tseconds\tspeedup"
+             << "\tefficiency\tbandwidth\ttriad" << endl;
+    }
+
+#ifdef __linux__
+    if (args.pinning && !allowed.empty()) {
+        vector<Placement> placements(1, unpinned);
+        placements.push_back(compact);
+        if (topology.size() > 1) {
+            placements.push_back(spread);
+        }
+        int res = EXIT_SUCCESS;
+        for (size_t p = 0; p < placements.size(); ++p) {
+            if (spawn(argc, argv, topology, placements[p], maxThreads) !=
+                    EXIT_SUCCESS) {
+                res = EXIT_FAILURE;
+            }
+        }
+        return res;
+    }
+#endif
+    return run(args, topology, unpinned, threadCounts);
+}
@@ -0,0 +1,136 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "Allocation.h"
+#include "Channel.h"
+#include "Fixtures.h"
+#include "VectorFitting.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class VectorFittingAllocationTest : public ::testing::Test {
+protected:
+    void SetUp() {
+        if (!Allocation::isTracking()) {
+            GTEST_SKIP() << "Built without CompileWithAllocationTracking";
+        }
+    }
+};
+
+TEST_F(VectorFittingAllocationTest, counters) {
+    const size_t count = Allocation::getCount();
+    const size_t current = Allocation::getCurrent();
+    const Allocation::Peak peak;
+    {
+        vector<double> buffer(1 << 20);
+        buffer[0] = 1.0;
+        EXPECT_EQ(count + 1, Allocation::getCount());
+        EXPECT_GE(Allocation::getCurrent(), current + (sizeof(double) << 20));
+    }
+    EXPECT_EQ(current, Allocation::getCurrent());
+    EXPECT_GE(peak.get(), current + (sizeof(double) << 20));
+    EXPECT_GE(Allocation::getPeak(), peak.get());
+}
+
+TEST_F(VectorFittingAllocationTest, peaks) {
+    // Restarting one mark, as a concurrent fit would, leaves the others.
+    const size_t current = Allocation::getCurrent();
+    Allocation::Peak outer;
+    {
+        vector<double> buffer(1 << 20);
+        buffer[0] = 1.0;
+    }
+    Allocation::Peak inner;
+    EXPECT_GE(outer.get(), current + (sizeof(double) << 20));
+    EXPECT_LT(inner.get(), current + (sizeof(double) << 20));
+    inner.reset();
+    EXPECT_GE(outer.get(), current + (sizeof(double) << 20));
+    {
+        vector<double> buffer(1 << 18);
+        buffer[0] = 1.0;
+    }
+    EXPECT_GE(inner.get(), current + (sizeof(double) << 18));
+}
+
+TEST_F(VectorFittingAllocationTest, guard) {
+    Channel<size_t> channel(16);
+    size_t value;
+    Allocation::Guard guard;
+    for (size_t i = 0; i < 100; ++i) {
+        channel.push(size_t(i));
+        channel.pop(value);
+    }
+    EXPECT_EQ(0, guard.getViolations());
+    vector<int> allocating(10);
+    EXPECT_EQ(1, guard.getViolations());
+}
+
+TEST_F(VectorFittingAllocationTest, fit) {
+    Options opts;
+    VectorFitting::VectorFitting fitting(Fixtures::getFdneRow(), 12, opts);
+    fitting.fit();
+    const Statistics first = fitting.fit();
+#ifndef CompileWithoutStatistics
+    EXPECT_GT(first.allocations[Statistics::assembly], 0);
+    EXPECT_GT(first.peakBytes[Statistics::assembly], 0);
+    EXPECT_GE(first.getAllocatedBytes(), first.getPeakBytes());
+#endif
+
+    // Once relocated, iterations are alike: the heap use of fit() must not
+    // grow with them.
+    const Statistics second = fitting.fit();
+    for (size_t p = 0; p < Statistics::numberOfPhases; ++p) {
+        EXPECT_EQ(first.allocations[p], second.allocations[p]);
+        EXPECT_EQ(first.allocatedBytes[p], second.allocatedBytes[p]);
+    }
+    const size_t current = Allocation::getCurrent();
+    fitting.fit();
+    EXPECT_EQ(current, Allocation::getCurrent());
+}
+
+TEST_F(VectorFittingAllocationTest, steadyStateBudget) {
+    // Once relocated, the allocations of an iteration, its error
+    // evaluation included, are fixed by the orders and the responses: none
+    // is made per sample.
+    vector<Sample> all = Fixtures::getFdneRow(), half;
+    for (size_t k = 0; k < all.size(); k += 2) {
+        half.push_back(all[k]);
+    }
+    Options opts;
+    VectorFitting::VectorFitting large(all, 12, opts), small(half, 12, opts);
+    large.fit();
+    small.fit();
+    large.fit();
+    small.fit();
+    const Statistics lhs = large.getResult().statistics;
+    const Statistics rhs = small.getResult().statistics;
+#ifndef CompileWithoutStatistics
+    for (size_t p = 0; p < Statistics::numberOfPhases; ++p) {
+        EXPECT_EQ(lhs.allocations[p], rhs.allocations[p])
+                << Statistics::getName((Statistics::Phase) p);
+    }
+    EXPECT_EQ(1, lhs.calls[Statistics::error]);
+#endif
+}
@@ -0,0 +1,137 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+#include "Assembly.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class VectorFittingAssemblyTest : public ::testing::Test {
+protected:
+    // More rows than a tile, and a last partial one.
+    static const size_t Ns = Assembly::tileSize + 13;
+
+    static MatrixXcd buildBasis(const size_t cols) {
+        MatrixXcd res(Ns, cols);
+        for (size_t m = 0; m < cols; ++m) {
+            for (size_t i = 0; i < Ns; ++i) {
+                res(i,m) = Complex(1.0, 0.0)
+                         / Complex(-1.0 - m, 0.5 * i - 3.0 * m);
+            }
+        }
+        return res;
+    }
+    static MatrixXd buildWeights(const size_t Nc) {
+        MatrixXd res(Ns, Nc);
+        for (size_t n = 0; n < Nc; ++n) {
+            for (size_t i = 0; i < Ns; ++i) {
+                res(i,n) = 1.0 + 0.1 * ((i + 3*n) % 7);
+            }
+        }
+        return res;
+    }
+    static MatrixXcd buildResponses(const size_t Nc) {
+        MatrixXcd res(Ns, Nc);
+        for (size_t n = 0; n < Nc; ++n) {
+            for (size_t i = 0; i < Ns; ++i) {
+                res(i,n) = Complex(std::cos(0.1 * i + n), std::sin(0.2 * i));
+            }
+        }
+        return res;
+    }
+};
+
+const size_t VectorFittingAssemblyTest::Ns;
+
+TEST_F(VectorFittingAssemblyTest, poleSystem) {
+    const size_t N = 6, left = N + 2, right = N + 1, n = 1;
+    const MatrixXcd Dk = buildBasis(N + 2);
+    const MatrixXd weights = buildWeights(3);
+    const MatrixXcd responses = buildResponses(3);
+    MatrixXd A;
+    Assembly::buildPoleSystem(Dk, left, right, weights, responses, n, A);
+
+    ASSERT_EQ(2*Ns + 1, A.rows());
+    ASSERT_EQ(left + right, A.cols());
+    EXPECT_TRUE(A.row(2*Ns).isZero());
+    for (size_t i = 0; i < Ns; ++i) {
+        for (size_t m = 0; m < left; ++m) {
+            const Complex entry = weights(i,n) * Dk(i,m);
+            EXPECT_EQ(real(entry), A(i,   m));
+            EXPECT_EQ(imag(entry), A(i+Ns,m));
+        }
+        for (size_t m = 0; m < right; ++m) {
+            const Complex entry = - weights(i,n) * Dk(i,m) * responses(i,n);
+            EXPECT_EQ(real(entry), A(i,   left+m));
+            EXPECT_EQ(imag(entry), A(i+Ns,left+m));
+        }
+    }
+}
+
+TEST_F(VectorFittingAssemblyTest, frozenPoleSystem) {
+    // Two frozen poles before the constant column N of the basis.
+    const size_t N = 6, frozen = 2, left = N + 1, right = N - frozen + 1;
+    const MatrixXcd Dk = buildBasis(N + 2);
+    const MatrixXd weights = buildWeights(2);
+    const MatrixXcd responses = buildResponses(2);
+    MatrixXd A, full;
+    Assembly::buildPoleSystem(Dk, left, right, weights, responses, 0, A,
+                              frozen);
+    Assembly::buildPoleSystem(Dk, left, N + 1, weights, responses, 0, full);
+
+    ASSERT_EQ(left + right, A.cols());
+    EXPECT_TRUE(A.leftCols(left + right - 1) ==
+                full.leftCols(left + right - 1));
+    EXPECT_TRUE(A.col(left + right - 1) == full.col(left + N));
+}
+
+TEST_F(VectorFittingAssemblyTest, residueSystem) {
+    // Only the leading columns of the basis.
+    const size_t cols = 5, n = 2;
+    const MatrixXcd basis = buildBasis(cols + 2);
+    const MatrixXd weights = buildWeights(4);
+    const MatrixXcd responses = buildResponses(4);
+    const MatrixXd norms = Assembly::getColumnNorms(basis, cols, weights);
+    ASSERT_EQ(cols, norms.rows());
+    ASSERT_EQ(4, norms.cols());
+
+    MatrixXd A;
+    VectorXd b;
+    Assembly::buildResidueSystem(basis, cols, weights, responses, norms, n,
+                                 A, b);
+    ASSERT_EQ(2*Ns, A.rows());
+    ASSERT_EQ(cols, A.cols());
+    ASSERT_EQ(2*Ns, b.size());
+    for (size_t m = 0; m < cols; ++m) {
+        EXPECT_NEAR(1.0, A.col(m).norm(), 1e-14);
+        for (size_t i = 0; i < Ns; ++i) {
+            const Complex entry = weights(i,n) * basis(i,m) / norms(m,n);
+            EXPECT_NEAR(real(entry), A(i,   m), 1e-15 * abs(entry));
+            EXPECT_NEAR(imag(entry), A(i+Ns,m), 1e-15 * abs(entry));
+        }
+    }
+    for (size_t i = 0; i < Ns; ++i) {
+        EXPECT_EQ(real(responses(i,n)) * weights(i,n), b(i));
+        EXPECT_EQ(imag(responses(i,n)) * weights(i,n), b(i+Ns));
+    }
+}
@@ -0,0 +1,145 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+#include "BasisCache.h"
+#include "Generator.h"
+#include "Hash.h"
+#include "PoleCache.h"
+#include "SampleSet.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class VectorFittingBasisCacheTest : public ::testing::Test {
+protected:
+    static shared_ptr<const SampleSet> buildSampleSet(const size_t seed) {
+        Generator generator(seed);
+        generator.setSamplesSize(200);
+        generator.setResponseSize(2);
+        generator.setOrder(6);
+        return SampleSet::build(generator.getSamples());
+    }
+};
+
+TEST_F(VectorFittingBasisCacheTest, store) {
+    const shared_ptr<const SampleSet> data = buildSampleSet(1);
+    const vector<Complex> starting =
+            VectorFitting::VectorFitting::getStartingPoles(*data, 6);
+    const VectorXcd poles = Eigen::Map<const VectorXcd>(starting.data(),
+                                                        starting.size());
+    const shared_ptr<const MatrixXcd> basis =
+            make_shared<MatrixXcd>(MatrixXcd::Ones(200, 8));
+
+    BasisCache cache;
+    EXPECT_FALSE(cache.get(*data, poles, Options::constant));
+    cache.set(*data, poles, Options::constant, basis);
+    EXPECT_EQ(1, cache.size());
+    EXPECT_EQ(basis, cache.get(*data, poles, Options::constant));
+    EXPECT_FALSE(cache.get(*data, poles, Options::linear));
+    VectorXcd moved = poles;
+    moved(0) *= 2.0;
+    EXPECT_FALSE(cache.get(*data, moved, Options::constant));
+    // Only the grid matters, not the responses.
+    EXPECT_EQ(basis, cache.get(*buildSampleSet(2), poles, Options::constant));
+    vector<Sample> shifted = data->getSamples();
+    shifted[100].first *= 1.0 + 1e-12;
+    EXPECT_FALSE(cache.get(SampleSet(shifted), poles, Options::constant));
+
+    cache.clear();
+    EXPECT_EQ(0, cache.size());
+    EXPECT_EQ(0, cache.getBytes());
+}
+
+TEST_F(VectorFittingBasisCacheTest, eviction) {
+    const shared_ptr<const SampleSet> data = buildSampleSet(1);
+    const size_t bytes = 200 * 8 * sizeof(Complex);
+    BasisCache cache(2 * bytes + bytes / 2);
+    vector<VectorXcd> poles(3, VectorXcd::Constant(6, Complex(-1.0, 0.0)));
+    for (size_t i = 0; i < poles.size(); ++i) {
+        poles[i](0) = Complex(-1.0 - i, 0.0);
+        if (i == 2) {
+            // Keeps the first one as the most recently used.
+            EXPECT_TRUE(cache.get(*data, poles[0], Options::constant));
+        }
+        cache.set(*data, poles[i], Options::constant,
+                  make_shared<MatrixXcd>(MatrixXcd::Zero(200, 8)));
+    }
+    EXPECT_EQ(2, cache.size());
+    EXPECT_GE(2 * bytes + bytes / 2, cache.getBytes());
+    EXPECT_TRUE(cache.get(*data, poles[0], Options::constant));
+    EXPECT_FALSE(cache.get(*data, poles[1], Options::constant));
+    EXPECT_TRUE(cache.get(*data, poles[2], Options::constant));
+
+    BasisCache small(bytes / 2);
+    small.set(*data, poles[0], Options::constant,
+              make_shared<MatrixXcd>(MatrixXcd::Zero(200, 8)));
+    EXPECT_EQ(0, small.size());
+}
+
+TEST_F(VectorFittingBasisCacheTest, shared) {
+    const shared_ptr<const SampleSet> data = buildSampleSet(3);
+    const vector<Complex> poles =
+            VectorFitting::VectorFitting::getStartingPoles(*data, 6);
+
+    VectorFitting::VectorFitting plain(data, poles, Options());
+    plain.fit();
+    plain.fit();
+
+    BasisCache cache;
+    VectorFitting::VectorFitting first(data, poles, Options());
+    first.setBasisCache(&cache);
+    first.fit();
+    ASSERT_EQ(1, cache.size());
+    const VectorXcd starting = Eigen::Map<const VectorXcd>(poles.data(),
+                                                           poles.size());
+    const shared_ptr<const MatrixXcd> stored =
+            cache.get(*data, starting, Options::constant);
+    ASSERT_TRUE(stored);
+    const MatrixXcd copy = *stored;
+    first.fit();
+    // Later iterations copy the basis before moving its columns.
+    EXPECT_EQ(copy, *stored);
+
+    VectorFitting::VectorFitting second(data, poles, Options());
+    second.setBasisCache(&cache);
+    EXPECT_EQ(poles.size(), second.fit().health.reusedColumns);
+    second.fit();
+
+    EXPECT_EQ(plain.getPoles(), first.getPoles());
+    EXPECT_EQ(plain.getPoles(), second.getPoles());
+    EXPECT_EQ(plain.getC(), first.getC());
+    EXPECT_EQ(plain.getC(), second.getC());
+}
+
+TEST_F(VectorFittingBasisCacheTest, hash) {
+    const shared_ptr<const SampleSet> data = buildSampleSet(1);
+    const VectorXcd& frequencies = data->getFrequencies();
+    uint64_t chained = hashSeed;
+    for (long i = 0; i < frequencies.size(); ++i) {
+        chained = hashValues(&frequencies(i), 1, chained);
+    }
+    EXPECT_EQ(hashValues(frequencies.data(), frequencies.size()), chained);
+    EXPECT_EQ(chained, data->getGridHash());
+    EXPECT_EQ(chained, PoleCache::hashGrid(data->getSamples()));
+    EXPECT_NE(chained, hashValues(frequencies.data(), frequencies.size()-1));
+}
@@ -0,0 +1,200 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include <cstdio>
+#include <sstream>
+
+#include "gtest/gtest.h"
+#include "BatchFitter.h"
+#include "Exporter.h"
+#include "Importer.h"
+#include "SampleSet.h"
+#include "SpaceGenerator.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class VectorFittingBatchFitterTest : public ::testing::Test {
+protected:
+    // Two complex pairs and a real pole, sampled on a linear grid.
+    static vector<Sample> buildSamples(const Real shift) {
+        const size_t nS = 200;
+        vector<Real> w = linspace(pair<Real,Real>(1.0, 1e4), nS);
+        vector<Sample> res(nS);
+        for (size_t k = 0; k < nS; ++k) {
+            const Complex s(0.0, 2.0 * M_PI * w[k]);
+            vector<Complex> f(2);
+            f[0] =  2.0 / (s + 5.0)
+                    + Complex(30.0,  40.0) / (s - Complex(-100.0,  500.0*shift))
+                    + Complex(30.0, -40.0) / (s - Complex(-100.0, -500.0*shift))
+                    + 0.5;
+            f[1] =    Complex(1e3,  2e3) / (s - Complex(-3e3,  2e4*shift))
+                    + Complex(1e3, -2e3) / (s - Complex(-3e3, -2e4*shift));
+            res[k] = Sample(s, f);
+        }
+        return res;
+    }
+};
+
+TEST_F(VectorFittingBatchFitterTest, samplesRoundTrip) {
+    vector<Sample> samples = buildSamples(1.0);
+    const string filename = "batchFitterTest.vfs";
+    Exporter::writeSamples(filename, samples);
+    vector<Sample> read = Importer::readSamples(filename);
+    remove(filename.c_str());
+
+    EXPECT_EQ(samples.size(), read.size());
+    for (size_t k = 0; k < samples.size(); ++k) {
+        EXPECT_EQ(samples[k].first, read[k].first);
+        EXPECT_EQ(samples[k].second, read[k].second);
+    }
+}
+
+TEST_F(VectorFittingBatchFitterTest, fdne) {
+    vector<Sample> samples = Importer::readSamples("testData/fdne.txt");
+    EXPECT_EQ(300, samples.size());
+    EXPECT_EQ(36, samples.front().second.size());
+    EXPECT_NEAR(62.83185307179586, samples.front().first.imag(), 1e-12);
+    EXPECT_NEAR( 0.3437945522115830, samples.front().second[0].real(), 1e-15);
+    EXPECT_NEAR(-0.0760339888051478, samples.front().second[0].imag(), 1e-15);
+}
+
+TEST_F(VectorFittingBatchFitterTest, touchstone) {
+    stringstream data;
+    data << "! Two port, real and imaginary parts" << endl
+         << "# MHz S RI R 50" << endl
+         << "1.0  0.1 0.2  0.3 0.4  0.5 0.6  0.7 0.8" << endl
+         << "2.0  1.0 0.0  0.0 1.0 ! trailing comment" << endl
+         << "     1.0 0.0  0.0 1.0" << endl;
+    vector<Sample> samples = Importer::readTouchstone(data, 2);
+    EXPECT_EQ(2, samples.size());
+    EXPECT_NEAR(2.0 * M_PI * 1e6, samples[0].first.imag(), 1e-6);
+    // N11 N21 N12 N22 is stored row by row.
+    EXPECT_EQ(Complex(0.1, 0.2), samples[0].second[0]);
+    EXPECT_EQ(Complex(0.5, 0.6), samples[0].second[1]);
+    EXPECT_EQ(Complex(0.3, 0.4), samples[0].second[2]);
+    EXPECT_EQ(Complex(0.7, 0.8), samples[0].second[3]);
+
+    stringstream polar;
+    polar << "# Hz S MA" << endl
+          << "10.0  2.0 90.0" << endl;
+    samples = Importer::readTouchstone(polar, 1);
+    EXPECT_NEAR(0.0, samples[0].second[0].real(), 1e-12);
+    EXPECT_NEAR(2.0, samples[0].second[0].imag(), 1e-12);
+}
+
+TEST_F(VectorFittingBatchFitterTest, orderSearch) {
+    BatchFitter fitter;
+    fitter.setOrders(2, 12, 2);
+    fitter.setTargetRMSE(1e-8);
+    fitter.setIterations(5);
+
+    vector<vector<Sample>> jobs;
+    jobs.push_back(buildSamples(1.0));
+    jobs.push_back(buildSamples(1.5));
+    vector<Result> results = fitter.fit(jobs);
+
+    EXPECT_EQ(2, results.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+        EXPECT_EQ(i, results[i].id);
+        EXPECT_LE(results[i].rmse, 1e-8);
+        EXPECT_LE(results[i].poles.size(), 8);
+        EXPECT_EQ(2, results[i].residues.rows());
+    }
+
+    const string filename = "batchFitterTest.vfm";
+    Exporter::writeModels(filename, results);
+    vector<Result> read = Importer::readModels(filename);
+    remove(filename.c_str());
+    EXPECT_EQ(results.size(), read.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+        EXPECT_EQ(results[i].poles, read[i].poles);
+        EXPECT_EQ(results[i].residues, read[i].residues);
+        EXPECT_EQ(results[i].D, read[i].D);
+        EXPECT_EQ(results[i].rmse, read[i].rmse);
+    }
+}
+
+TEST_F(VectorFittingBatchFitterTest, refinedPoles) {
+    const vector<Sample> samples = buildSamples(1.0);
+    const SampleSet data(samples);
+    vector<Real> errors(samples.size(), 1.0);
+    errors[20] = 3.0;
+    errors[150] = 2.0;
+    errors[151] = 2.0;
+    const vector<Complex> poles(2, Complex(-1.0, 0.0));
+
+    const vector<Complex> refined =
+            VectorFitting::VectorFitting::getRefinedPoles(data, poles,
+                                                          errors, 3);
+    // Flat errors have no peaks, only two pairs are added.
+    ASSERT_EQ(6, refined.size());
+    EXPECT_EQ(poles[0], refined[0]);
+    EXPECT_EQ(poles[1], refined[1]);
+    EXPECT_EQ(samples[20].first.imag(), refined[2].imag());
+    EXPECT_EQ(conj(refined[2]), refined[3]);
+    EXPECT_EQ(samples[150].first.imag(), refined[4].imag());
+    EXPECT_GT(0.0, refined[4].real());
+
+    errors.pop_back();
+    EXPECT_THROW(VectorFitting::VectorFitting::getRefinedPoles(
+            data, poles, errors, 1), runtime_error);
+}
+
+TEST_F(VectorFittingBatchFitterTest, refinement) {
+    vector<vector<Sample>> jobs;
+    jobs.push_back(buildSamples(1.0));
+    jobs.push_back(buildSamples(1.5));
+
+    BatchFitter restart;
+    restart.setOrders(2, 12, 2);
+    restart.setTargetRMSE(1e-8);
+    restart.setIterations(5);
+    BatchFitter refinement = restart;
+    refinement.setRefinement(true);
+    const vector<Result> restarted = restart.fit(jobs);
+    const vector<Result> refined = refinement.fit(jobs);
+
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        EXPECT_LE(refined[i].rmse, 1e-8);
+        EXPECT_LE(refined[i].poles.size(), restarted[i].poles.size() + 2);
+        EXPECT_LT(refined[i].statistics.iterations,
+                  restarted[i].statistics.iterations);
+    }
+}
+
+TEST_F(VectorFittingBatchFitterTest, channel) {
+    BatchFitter fitter;
+    fitter.setOrders(6, 6);
+    vector<vector<Sample>> jobs(3, buildSamples(1.0));
+    ResultChannel channel(4);
+    fitter.fit(jobs, channel);
+
+    vector<bool> seen(jobs.size(), false);
+    Result result;
+    while (channel.tryPop(result)) {
+        EXPECT_LT(result.id, jobs.size());
+        seen[result.id] = true;
+    }
+    for (size_t i = 0; i < seen.size(); ++i) {
+        EXPECT_TRUE(seen[i]);
+    }
+}
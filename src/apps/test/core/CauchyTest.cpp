@@ -0,0 +1,132 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+#include "Cauchy.h"
+#include "Generator.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class VectorFittingCauchyTest : public ::testing::Test {
+protected:
+    static VectorXcd buildFrequencies(const size_t Ns) {
+        VectorXcd res(Ns);
+        for (size_t i = 0; i < Ns; ++i) {
+            res(i) = Complex(0.0, 1.0 + 1e3 * i / (Ns - 1.0));
+        }
+        return res;
+    }
+    // Pairs spread over the band, a few of them clustered, and a real one.
+    static VectorXcd buildPoles(const size_t N) {
+        VectorXcd res(N);
+        res(0) = Complex(-50.0, 0.0);
+        size_t m = 1;
+        for (; m + 1 < N; m += 2) {
+            const Real imag = (m < N / 4) ? 400.0 + 0.1 * m : 1e3 * m / N;
+            res(m)   = Complex(-1.0 - 0.01 * imag, imag);
+            res(m+1) = conj(res(m));
+        }
+        if (m < N) {
+            res(m) = Complex(-2.0, 0.0);
+        }
+        return res;
+    }
+    static MatrixXcd denseProduct(const VectorXcd& s, const VectorXcd& p,
+                                  const MatrixXcd& X) {
+        MatrixXcd K(s.size(), p.size());
+        for (int m = 0; m < p.size(); ++m) {
+            for (int i = 0; i < s.size(); ++i) {
+                K(i,m) = Complex(1.0, 0.0) / (s(i) - p(m));
+            }
+        }
+        return K * X;
+    }
+};
+
+TEST_F(VectorFittingCauchyTest, tolerance) {
+    const VectorXcd s = buildFrequencies(1500);
+    const VectorXcd p = buildPoles(301);
+    const MatrixXcd X = MatrixXcd::Random(p.size(), 3);
+    const MatrixXcd exact = denseProduct(s, p, X);
+
+    // Bound of each entry: the sum of the magnitudes of its terms.
+    MatrixXd magnitudes = MatrixXd::Zero(s.size(), X.cols());
+    for (int i = 0; i < s.size(); ++i) {
+        for (int m = 0; m < p.size(); ++m) {
+            magnitudes.row(i) += X.row(m).cwiseAbs() / abs(s(i) - p(m));
+        }
+    }
+    const Real tolerances[] = {1e-3, 1e-8, 1e-12};
+    for (size_t t = 0; t < 3; ++t) {
+        const Cauchy cauchy(s, p, tolerances[t]);
+        EXPECT_FALSE(cauchy.isDense());
+        const MatrixXcd res = cauchy.multiply(X);
+        ASSERT_EQ(s.size(), res.rows());
+        ASSERT_EQ(X.cols(), res.cols());
+        const MatrixXd error = (res - exact).cwiseAbs();
+        EXPECT_TRUE((error.array() <=
+                     tolerances[t] * magnitudes.array() + 1e-13).all());
+    }
+}
+
+TEST_F(VectorFittingCauchyTest, dense) {
+    const VectorXcd s = buildFrequencies(200);
+    const MatrixXcd small = MatrixXcd::Random(Cauchy::denseOrder - 1, 2);
+    const VectorXcd p = buildPoles(small.rows());
+    EXPECT_TRUE(Cauchy(s, p, 1e-6).isDense());
+    EXPECT_EQ(0, Cauchy(s, p, 1e-6).getTerms());
+    EXPECT_TRUE(Cauchy(s, buildPoles(200)).isDense());
+    const MatrixXcd res = Cauchy(s, p, 1e-6).multiply(small);
+    EXPECT_LT((res - denseProduct(s, p, small)).norm(), 1e-12 * res.norm());
+
+    EXPECT_THROW(Cauchy(s, p, -1.0), runtime_error);
+    EXPECT_THROW(Cauchy(s, p, 1.0), runtime_error);
+    EXPECT_THROW(Cauchy(s, p).multiply(MatrixXcd::Zero(3, 1)),
+                 runtime_error);
+}
+
+TEST_F(VectorFittingCauchyTest, fittedSamples) {
+    Generator generator(8);
+    generator.setSamplesSize(1000);
+    generator.setOrder(140);
+    generator.setResponseSize(2);
+    const vector<Sample> samples = generator.getSamples();
+    VectorFitting::VectorFitting fitting(samples, 140, Options());
+    fitting.fit();
+    const vector<Sample> dense = fitting.getFittedSamples();
+
+    Options opts;
+    opts.setEvaluationTolerance(1e-10);
+    fitting.setOptions(opts);
+    const vector<Sample> fast = fitting.getFittedSamples();
+    ASSERT_EQ(dense.size(), fast.size());
+    Real error = 0.0, norm = 0.0;
+    for (size_t i = 0; i < dense.size(); ++i) {
+        EXPECT_EQ(dense[i].first, fast[i].first);
+        for (size_t n = 0; n < dense[i].second.size(); ++n) {
+            error = max(error, abs(dense[i].second[n] - fast[i].second[n]));
+            norm  = max(norm,  abs(dense[i].second[n]));
+        }
+    }
+    EXPECT_LT(error, 1e-8 * norm);
+}
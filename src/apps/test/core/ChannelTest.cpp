@@ -0,0 +1,139 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "VectorFitting.h"
+#include "SpaceGenerator.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class VectorFittingChannelTest : public ::testing::Test {
+
+};
+
+TEST_F(VectorFittingChannelTest, ctor) {
+    EXPECT_THROW(Channel<int>(0), runtime_error);
+    Channel<int> channel(5);
+    EXPECT_EQ(8, channel.getCapacity());
+}
+
+TEST_F(VectorFittingChannelTest, fifo) {
+    Channel<int> channel(4);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(channel.tryPush(int(i)));
+    }
+    EXPECT_FALSE(channel.tryPush(4));
+
+    int value;
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(channel.tryPop(value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_FALSE(channel.tryPop(value));
+
+    channel.push(7);
+    channel.close();
+    EXPECT_TRUE(channel.pop(value));
+    EXPECT_EQ(7, value);
+    EXPECT_FALSE(channel.pop(value));
+}
+
+TEST_F(VectorFittingChannelTest, multipleProducersAndConsumers) {
+    const size_t nProducers = 4, nConsumers = 3, nValues = 10000;
+    Channel<size_t> channel(64);
+
+    vector<thread> producers;
+    for (size_t p = 0; p < nProducers; ++p) {
+        producers.push_back(thread([&channel, p]() {
+            for (size_t i = 0; i < nValues; ++i) {
+                channel.push(p*nValues + i + 1);
+            }
+        }));
+    }
+    vector<size_t> sums(nConsumers, 0), counts(nConsumers, 0);
+    vector<thread> consumers;
+    for (size_t c = 0; c < nConsumers; ++c) {
+        consumers.push_back(thread([&channel, &sums, &counts, c]() {
+            size_t value;
+            while (channel.pop(value)) {
+                sums[c] += value;
+                counts[c]++;
+            }
+        }));
+    }
+    for (size_t p = 0; p < nProducers; ++p) {
+        producers[p].join();
+    }
+    channel.close();
+    for (size_t c = 0; c < nConsumers; ++c) {
+        consumers[c].join();
+    }
+
+    size_t sum = 0, count = 0;
+    for (size_t c = 0; c < nConsumers; ++c) {
+        sum += sums[c];
+        count += counts[c];
+    }
+    const size_t total = nProducers * nValues;
+    EXPECT_EQ(total, count);
+    EXPECT_EQ(total * (total + 1) / 2, sum);
+}
+
+TEST_F(VectorFittingChannelTest, resultHandOff) {
+    const size_t nS = 101;
+    vector<Real> sImag = logspace(pair<Real,Real>(0.0,4.0), nS);
+    vector<Sample> samples(nS);
+    for (size_t k = 0; k < nS; k++) {
+        const Complex s(0.0, 2.0 * M_PI * sImag[k]);
+        vector<Complex> f(1);
+        f[0] =  2.0 /(s + 5.0)
+                + Complex(30.0,40.0)  / (s - Complex(-100.0,500.0))
+                + Complex(30.0,-40.0) / (s - Complex(-100.0,-500.0))
+                + 0.5;
+        samples[k] = Sample(s, f);
+    }
+    vector<Complex> poles = {
+            Complex(-2 * M_PI, 0.0),
+            Complex(-2 * M_PI * 1e2, 0.0),
+            Complex(-2 * M_PI * 1e4, 0.0)};
+
+    Options opts;
+    opts.setAsymptoticTrend(Options::linear);
+    VectorFitting::VectorFitting fitting(samples, poles, opts);
+    fitting.fit();
+
+    ResultChannel channel(2);
+    Result produced = fitting.getResult(42);
+    const Complex* buffer = produced.residues.data();
+    channel.push(std::move(produced));
+
+    Result consumed;
+    EXPECT_TRUE(channel.tryPop(consumed));
+    EXPECT_EQ(42, consumed.id);
+    EXPECT_EQ(buffer, consumed.residues.data());
+    EXPECT_EQ(3, consumed.poles.size());
+    EXPECT_EQ(1, consumed.residues.rows());
+    EXPECT_NEAR(0.0, consumed.rmse, 1e-8);
+    EXPECT_NEAR(-5.0, consumed.poles(0).real(), 1e-6);
+}
@@ -0,0 +1,143 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include <chrono>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "gtest/gtest.h"
+#include "CostModel.h"
+#include "Importer.h"
+#include "Tuning.h"
+#include "VectorFitting.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class VectorFittingCostModelTest : public ::testing::Test {
+protected:
+    static CostModel::Problem buildProblem() {
+        CostModel::Problem res;
+        res.Ns = 300;
+        res.N  = 20;
+        res.Nc = 36;
+        res.threads = 1;
+        return res;
+    }
+};
+
+TEST_F(VectorFittingCostModelTest, scaling) {
+    CostModel model;
+    const CostModel::Problem problem = buildProblem();
+    const CostModel::Estimate base = model.estimate(problem);
+    EXPECT_GT(base.getFlops(), 0.0);
+    EXPECT_GT(base.seconds, model.getOverhead());
+
+    // Per response systems dominate: linear in Nc, quadratic in N.
+    CostModel::Problem twice = problem;
+    twice.Nc *= 2;
+    EXPECT_NEAR(2.0, model.estimate(twice).poleFlops / base.poleFlops, 0.01);
+    twice = problem;
+    twice.N *= 2;
+    EXPECT_GT(model.estimate(twice).poleFlops / base.poleFlops, 3.0);
+
+    // Dk for 300 samples and 22 columns.
+    EXPECT_EQ(300*22*16, base.basisBytes);
+    // One copy of the frequencies, responses and weights.
+    EXPECT_EQ(300*16 + 300*36*(16+8), base.dataBytes);
+    EXPECT_GE(base.getPeakBytes(), base.dataBytes + base.basisBytes);
+
+    // Only one response system per thread is alive.
+    CostModel::Problem threaded = problem;
+    threaded.threads = 4;
+    const CostModel::Estimate parallel = model.estimate(threaded);
+    EXPECT_EQ(4*base.responseBytes, parallel.responseBytes);
+    EXPECT_LT(parallel.seconds, base.seconds);
+    EXPECT_EQ(base.getFlops(), parallel.getFlops());
+
+    CostModel::Problem noPoles = problem;
+    noPoles.options.setSkipPoleIdentification(true);
+    EXPECT_EQ(0.0, model.estimate(noPoles).poleFlops);
+    EXPECT_EQ(0, model.estimate(noPoles).responseBytes);
+
+    EXPECT_THROW(model.setFlopRate(0.0), runtime_error);
+    EXPECT_THROW(model.setParallelEfficiency(1.5), runtime_error);
+}
+
+TEST_F(VectorFittingCostModelTest, calibrate) {
+    CostModel model;
+    model.calibrate();
+    EXPECT_GT(model.getFlopRate(), 0.0);
+    EXPECT_GE(model.getOverhead(), 0.0);
+
+    // Predictions are meant for packing, an order of magnitude is enough.
+    vector<Sample> samples = Importer::readSamples("testData/fdne.txt");
+    CostModel::Problem problem = buildProblem();
+    problem.threads = 0;
+    const Real predicted = model.estimate(problem).seconds;
+    Options opts;
+    VectorFitting::VectorFitting fitting(samples, problem.N, opts);
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    fitting.fit();
+    const Result result = fitting.getResult();
+    const Real measured = chrono::duration<Real>(
+            chrono::steady_clock::now() - start).count();
+    EXPECT_LT(predicted, 10.0 * measured);
+    EXPECT_GT(predicted, 0.1 * measured);
+
+#ifndef CompileWithoutStatistics
+    // Calibration times fit() and getResult(), whose evaluation of the
+    // model is the one estimate() charges.
+    problem.Ns = samples.size();
+    problem.Nc = samples.front().second.size();
+    EXPECT_DOUBLE_EQ(model.estimate(problem).errorFlops,
+                     result.statistics.flops[Statistics::error]);
+#endif
+}
+
+TEST_F(VectorFittingCostModelTest, calibrateThreads) {
+    // Serial fits of the calibration run on one thread whatever the
+    // profile says, and the profile is left as it was.
+#ifdef _OPENMP
+    const int maxThreads = omp_get_max_threads();
+#endif
+    Tuning tuning;
+    tuning.fitThreads = 1;
+    Tuning::set(tuning);
+    CostModel serial;
+    serial.calibrate();
+    EXPECT_EQ(1, Tuning::get().fitThreads);
+
+    tuning.fitThreads = 8;
+    Tuning::set(tuning);
+    CostModel threaded;
+    threaded.calibrate();
+    EXPECT_EQ(8, Tuning::get().fitThreads);
+    Tuning::set(Tuning());
+#ifdef _OPENMP
+    EXPECT_EQ(maxThreads, omp_get_max_threads());
+#endif
+
+    EXPECT_GT(threaded.getFlopRate(), 0.5 * serial.getFlopRate());
+    EXPECT_LT(threaded.getFlopRate(), 2.0 * serial.getFlopRate());
+}
@@ -0,0 +1,90 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+#include "Counters.h"
+#include "Generator.h"
+#include "Statistics.h"
+#include "VectorFitting.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class VectorFittingCountersTest : public ::testing::Test {
+protected:
+    void TearDown() {
+        Counters::setEnabled(false);
+    }
+};
+
+TEST_F(VectorFittingCountersTest, disabled) {
+    EXPECT_FALSE(Counters::isEnabled());
+    uint64_t values[Counters::numberOfEvents];
+    Counters::read(values);
+    for (int e = 0; e < Counters::numberOfEvents; ++e) {
+        EXPECT_EQ(0, values[e]);
+    }
+    EXPECT_STREQ("instructions", Counters::getName(Counters::instructions));
+}
+
+TEST_F(VectorFittingCountersTest, fit) {
+    Generator generator(2);
+    generator.setSamplesSize(500);
+    generator.setOrder(10);
+    generator.setResponseSize(2);
+    Counters::setEnabled(true);
+    VectorFitting::VectorFitting fitting(generator.getSamples(), 10,
+                                         Options());
+    Statistics statistics = fitting.fit();
+    statistics += fitting.fit();
+
+    // Wherever counters are refused, everything reads zero.
+    uint64_t instructions = 0;
+    for (size_t p = 0; p < Statistics::numberOfPhases; ++p) {
+        const Statistics::Phase phase = (Statistics::Phase) p;
+        instructions += statistics.counters[p][Counters::instructions];
+        EXPECT_LE(0.0, statistics.getIPC(phase));
+        EXPECT_LE(0.0, statistics.getCacheMissRate(phase));
+        EXPECT_GE(1.0, statistics.getCacheMissRate(phase));
+    }
+#ifndef CompileWithoutStatistics
+    if (Counters::isAvailable(Counters::instructions)) {
+        EXPECT_LT(0, instructions);
+        EXPECT_LT(0.0, statistics.getIPC(Statistics::assembly));
+    } else {
+        EXPECT_EQ(0, instructions);
+    }
+#endif
+}
+
+TEST_F(VectorFittingCountersTest, unavailable) {
+    // Events the host does not count, such as floating point instructions
+    // before Broadwell or on other vendors, are reported and read as zero.
+    Counters::setEnabled(true);
+    uint64_t values[Counters::numberOfEvents];
+    Counters::read(values);
+    for (int e = 0; e < Counters::numberOfEvents; ++e) {
+        if (!Counters::isAvailable((Counters::Event) e)) {
+            EXPECT_EQ(0, values[e]) << Counters::getName((Counters::Event) e);
+        }
+    }
+}
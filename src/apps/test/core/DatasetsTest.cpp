@@ -0,0 +1,59 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+#include "Datasets.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class VectorFittingDatasetsTest : public ::testing::Test {
+
+};
+
+TEST_F(VectorFittingDatasetsTest, references) {
+    const vector<Dataset> references = Datasets::getReferences();
+    ASSERT_EQ(3, references.size());
+    for (size_t d = 0; d < references.size(); ++d) {
+        const Dataset& dataset = references[d];
+        Options opts;
+        opts.setAsymptoticTrend(dataset.trend);
+        VectorFitting::VectorFitting fitting(dataset.samples, dataset.order,
+                                             opts);
+        for (size_t iter = 0; iter < 5; ++iter) {
+            fitting.fit();
+        }
+        EXPECT_LT(fitting.getRMSE(), 1e-8) << dataset.name;
+    }
+}
+
+TEST_F(VectorFittingDatasetsTest, generate) {
+    Generator generator(2);
+    generator.setSamplesSize(50);
+    generator.setOrder(6);
+    generator.setAsymptoticTrend(Options::linear);
+    const Dataset dataset = Datasets::generate(generator, "small");
+    EXPECT_EQ("small", dataset.name);
+    EXPECT_EQ(6, dataset.order);
+    EXPECT_EQ(Options::linear, dataset.trend);
+    EXPECT_EQ(generator.getSamples(), dataset.samples);
+}
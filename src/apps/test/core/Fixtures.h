@@ -0,0 +1,49 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEMBA_VECTOR_FITTING_TEST_FIXTURES_H_
+#define SEMBA_VECTOR_FITTING_TEST_FIXTURES_H_
+
+#include <vector>
+
+#include "Importer.h"
+
+namespace VectorFitting {
+
+/**
+ * Samples shared by several test suites, read relative to the root of the
+ * repository like the rest of testData/.
+ */
+class Fixtures {
+public:
+    // First row of the admittance in fdne.txt, six responses.
+    static std::vector<Sample> getFdneRow() {
+        std::vector<Sample> res = Importer::readSamples("testData/fdne.txt");
+        for (std::size_t k = 0; k < res.size(); ++k) {
+            res[k].second.resize(6);
+        }
+        return res;
+    }
+};
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_TEST_FIXTURES_H_ */
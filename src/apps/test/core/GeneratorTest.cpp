@@ -0,0 +1,125 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include <sstream>
+
+#include "gtest/gtest.h"
+#include "Generator.h"
+#include "Importer.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class VectorFittingGeneratorTest : public ::testing::Test {
+
+};
+
+TEST_F(VectorFittingGeneratorTest, model) {
+    Generator generator(3);
+    generator.setOrder(11);
+    generator.setResponseSize(4);
+    generator.setClustering(0.6, 0.05);
+    generator.setAsymptoticTrend(Options::linear);
+    const Result model = generator.getModel();
+
+    EXPECT_EQ(11, model.poles.size());
+    EXPECT_EQ(4, model.residues.rows());
+    EXPECT_EQ(0.0, model.poles(0).imag());
+    EXPECT_EQ(0.0, model.residues(0,0).imag());
+    for (long i = 0; i < model.poles.size(); ++i) {
+        EXPECT_LT(model.poles(i).real(), 0.0);
+    }
+    for (long i = 1; i < model.poles.size(); i += 2) {
+        EXPECT_EQ(conj(model.poles(i)), model.poles(i+1));
+        EXPECT_EQ(conj(model.residues(2,i)), model.residues(2,i+1));
+    }
+    EXPECT_NE(0.0, model.E(0).real());
+
+    // Three out of five pairs lie within 5% of a common frequency.
+    size_t clustered = 0;
+    for (long i = 1; i < model.poles.size(); i += 2) {
+        for (long j = 1; j < model.poles.size(); j += 2) {
+            if (i != j && model.poles(j).imag() / model.poles(i).imag() < 1.1
+                       && model.poles(i).imag() / model.poles(j).imag() < 1.1) {
+                clustered++;
+                break;
+            }
+        }
+    }
+    EXPECT_GE(clustered, 3);
+
+    EXPECT_THROW(generator.setClustering(2.0, 0.1), runtime_error);
+    EXPECT_THROW(generator.setConditioning(0.5), runtime_error);
+}
+
+TEST_F(VectorFittingGeneratorTest, reproducible) {
+    Generator generator(7);
+    generator.setSamplesSize(5000);
+    generator.setResponseSize(2);
+    generator.setNoise(1e-3);
+    const vector<Sample> samples = generator.getSamples();
+    EXPECT_EQ(samples, Generator(generator).getSamples());
+
+    // Streamed in several blocks, same values.
+    stringstream stream;
+    generator.write(stream);
+    EXPECT_EQ(samples, Importer::readBinary(stream));
+
+    generator.setSeed(8);
+    EXPECT_NE(samples, generator.getSamples());
+}
+
+TEST_F(VectorFittingGeneratorTest, noise) {
+    Generator generator;
+    generator.setSamplesSize(2000);
+    generator.setResponseSize(3);
+    const Result model = generator.getModel();
+    const vector<Sample> exact = generator.getSamples();
+    for (size_t k = 0; k < exact.size(); k += 100) {
+        EXPECT_EQ(Generator::evaluate(model, 1, exact[k].first),
+                  exact[k].second[1]);
+    }
+
+    generator.setNoise(1e-2);
+    const vector<Sample> noisy = generator.getSamples();
+    Real sum = 0.0;
+    for (size_t k = 0; k < exact.size(); ++k) {
+        for (size_t n = 0; n < 3; ++n) {
+            sum += norm(noisy[k].second[n] - exact[k].second[n])
+                 / norm(exact[k].second[n]);
+        }
+    }
+    EXPECT_NEAR(1e-2, sqrt(sum / (3.0 * exact.size())), 1e-3);
+}
+
+TEST_F(VectorFittingGeneratorTest, fit) {
+    Generator generator(1);
+    generator.setSamplesSize(400);
+    generator.setResponseSize(3);
+    generator.setOrder(8);
+    generator.setConditioning(10.0);
+    VectorFitting::VectorFitting fitting(generator.getSamples(), 12,
+                                         Options());
+    for (size_t iter = 0; iter < 10; ++iter) {
+        fitting.fit();
+    }
+    EXPECT_LT(fitting.getRMSE(), 1e-6);
+}
@@ -0,0 +1,144 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+#include "Protocol.h"
+#include "SpaceGenerator.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class VectorFittingProtocolTest : public ::testing::Test {
+protected:
+    static vector<Sample> buildSamples() {
+        vector<Real> w = logspace(pair<Real,Real>(0.0, 4.0), (size_t) 101);
+        vector<Sample> res(w.size());
+        for (size_t k = 0; k < w.size(); ++k) {
+            const Complex s(0.0, 2.0 * M_PI * w[k]);
+            vector<Complex> f(1);
+            f[0] =  2.0 / (s + 5.0)
+                    + Complex(30.0,  40.0) / (s - Complex(-100.0,  500.0))
+                    + Complex(30.0, -40.0) / (s - Complex(-100.0, -500.0))
+                    + 0.5;
+            res[k] = Sample(s, f);
+        }
+        return res;
+    }
+};
+
+TEST_F(VectorFittingProtocolTest, request) {
+    Protocol::Request request;
+    request.id = 7;
+    request.minOrder = 4;
+    request.maxOrder = 8;
+    request.targetRMSE = 1e-6;
+    request.trend = Options::linear;
+    request.weighting = BatchFitter::inverseMagnitude;
+    request.samples = buildSamples();
+
+    Protocol::Request decoded =
+            Protocol::decodeRequest(Protocol::encode(request));
+    EXPECT_EQ(request.id, decoded.id);
+    EXPECT_EQ(request.minOrder, decoded.minOrder);
+    EXPECT_EQ(request.maxOrder, decoded.maxOrder);
+    EXPECT_EQ(request.iterations, decoded.iterations);
+    EXPECT_EQ(request.targetRMSE, decoded.targetRMSE);
+    EXPECT_EQ(request.trend, decoded.trend);
+    EXPECT_EQ(request.weighting, decoded.weighting);
+    EXPECT_EQ(request.samples, decoded.samples);
+
+    EXPECT_THROW(Protocol::decodeRequest("garbage"), runtime_error);
+    const string payload = Protocol::encode(request);
+    EXPECT_THROW(Protocol::decodeRequest(payload.substr(0, 50)),
+                 runtime_error);
+    EXPECT_THROW(Protocol::decodeRequest(payload.substr(0, 60)),
+                 runtime_error);
+
+    request.samples.clear();
+    EXPECT_EQ(Protocol::requestHeaderSize, Protocol::encode(request).size());
+
+    // Sizes in the header beyond the payload are refused before allocating.
+    const size_t header = Protocol::requestHeaderSize - 2 * sizeof(uint64_t);
+    const uint64_t sizes[][2] = {{uint64_t(1) << 40, 1},
+                                 {1, uint64_t(1) << 40},
+                                 {2, ~uint64_t(0)},
+                                 {101, 1}};
+    for (size_t i = 0; i < 4; ++i) {
+        string truncated = payload.substr(0, header);
+        truncated.append(reinterpret_cast<const char*>(sizes[i]),
+                         sizeof(sizes[i]));
+        truncated.append(payload, Protocol::requestHeaderSize, 1000);
+        EXPECT_THROW(Protocol::decodeRequest(truncated), runtime_error);
+    }
+}
+
+TEST_F(VectorFittingProtocolTest, response) {
+    Protocol::Response error;
+    error.id = 3;
+    error.error = "Something went wrong";
+    Protocol::Response decoded =
+            Protocol::decodeResponse(Protocol::encode(error));
+    EXPECT_EQ(3, decoded.id);
+    EXPECT_FALSE(decoded.ok);
+    EXPECT_EQ(error.error, decoded.error);
+
+    Protocol::Request request;
+    request.minOrder = request.maxOrder = 4;
+    request.trend = Options::linear;
+    request.samples = buildSamples();
+    Protocol::Response response;
+    response.ok = true;
+    response.model = Protocol::getFitter(request).fit(request.samples);
+    decoded = Protocol::decodeResponse(Protocol::encode(response));
+    EXPECT_TRUE(decoded.ok);
+    EXPECT_EQ(response.model.poles, decoded.model.poles);
+    EXPECT_EQ(response.model.residues, decoded.model.residues);
+    EXPECT_EQ(response.model.E, decoded.model.E);
+    EXPECT_NEAR(0.0, decoded.model.rmse, 1e-8);
+}
+
+TEST_F(VectorFittingProtocolTest, poleCache) {
+    vector<Sample> samples = buildSamples();
+    PoleCache cache(2);
+    vector<Complex> poles;
+    EXPECT_FALSE(cache.get(samples, 4, Options::linear, poles));
+
+    BatchFitter fitter;
+    Options opts;
+    opts.setAsymptoticTrend(Options::linear);
+    fitter.setOptions(opts);
+    fitter.setOrders(4, 4);
+    fitter.setIterations(1);
+    fitter.setPoleCache(&cache);
+    const Real cold = fitter.fit(samples).rmse;
+    EXPECT_TRUE(cache.get(samples, 4, Options::linear, poles));
+    EXPECT_EQ(4, poles.size());
+    EXPECT_FALSE(cache.get(samples, 4, Options::constant, poles));
+
+    // A single warm iteration improves on the single cold one.
+    const Real warm = fitter.fit(samples).rmse;
+    EXPECT_LT(warm, cold);
+
+    cache.set(samples, 6, Options::linear, vector<Complex>(6));
+    cache.set(samples, 8, Options::linear, vector<Complex>(8));
+    EXPECT_EQ(2, cache.size());
+    EXPECT_FALSE(cache.get(samples, 4, Options::linear, poles));
+}
@@ -0,0 +1,165 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "BatchFitter.h"
+#include "Fixtures.h"
+#include "Reducer.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class VectorFittingReducerTest : public ::testing::Test {
+protected:
+    // Participants are threads of this process sharing a Group.
+    class Group {
+    public:
+        Group(const size_t size)
+        :   size_(size), arrived_(0), generation_(0),
+            R_(size), b_(size), C_(size), D_(size), E_(size) {}
+
+        size_t getSize() const { return size_; }
+
+        void barrier() {
+            unique_lock<mutex> lock(mutex_);
+            const size_t generation = generation_;
+            if (++arrived_ == size_) {
+                arrived_ = 0;
+                ++generation_;
+                condition_.notify_all();
+            } else {
+                condition_.wait(lock, [&]{return generation != generation_;});
+            }
+        }
+
+        const size_t size_;
+        mutex mutex_;
+        condition_variable condition_;
+        size_t arrived_, generation_;
+        vector<MatrixXd> R_;
+        vector<VectorXd> b_;
+        vector<MatrixXcd> C_;
+        vector<VectorXcd> D_, E_;
+    };
+
+    class ThreadReducer : public Reducer {
+    public:
+        ThreadReducer(Group& group, const size_t rank)
+        :   group_(group), rank_(rank) {}
+
+        pair<size_t, size_t> getResponseRange(const size_t Nc) const {
+            return pair<size_t, size_t>(
+                    Nc *  rank_      / group_.getSize(),
+                    Nc * (rank_ + 1) / group_.getSize());
+        }
+
+        void reduce(MatrixXd& R, VectorXd& b) {
+            group_.R_[rank_] = R;
+            group_.b_[rank_] = b;
+            group_.barrier();
+            R.resize(0, R.cols());
+            b.resize(0);
+            for (size_t p = 0; p < group_.getSize(); ++p) {
+                merge(R, b, group_.R_[p], group_.b_[p]);
+            }
+            group_.barrier();
+        }
+
+        void gather(MatrixXcd& C, VectorXcd& D, VectorXcd& E) {
+            group_.C_[rank_] = C;
+            group_.D_[rank_] = D;
+            group_.E_[rank_] = E;
+            group_.barrier();
+            for (size_t p = 0; p < group_.getSize(); ++p) {
+                const pair<size_t, size_t> range =
+                        ThreadReducer(group_, p).getResponseRange(C.rows());
+                for (size_t n = range.first; n < range.second; ++n) {
+                    C.row(n) = group_.C_[p].row(n);
+                    D(n) = group_.D_[p](n);
+                    E(n) = group_.E_[p](n);
+                }
+            }
+            group_.barrier();
+        }
+
+    private:
+        Group& group_;
+        const size_t rank_;
+    };
+};
+
+TEST_F(VectorFittingReducerTest, merge) {
+    MatrixXd A = MatrixXd::Random(12, 4);
+    VectorXd b = VectorXd::Random(12);
+    const VectorXd expected = A.householderQr().solve(b);
+
+    MatrixXd R(0, 4);
+    VectorXd c(0);
+    for (size_t i = 0; i < 3; ++i) {
+        Reducer::merge(R, c, A.middleRows(4*i, 4), b.segment(4*i, 4));
+    }
+    EXPECT_EQ(4, R.rows());
+    const VectorXd x = R.triangularView<Upper>().solve(c);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_NEAR(expected(i), x(i), 1e-12);
+    }
+}
+
+TEST_F(VectorFittingReducerTest, splitFit) {
+    const vector<Sample> samples = Fixtures::getFdneRow();
+    Options opts;
+    opts.setAsymptoticTrend(Options::linear);
+    BatchFitter fitter(opts);
+    fitter.setOrders(12, 12);
+    fitter.setIterations(3);
+    fitter.setWeighting(BatchFitter::inverseSqrtMagnitude);
+    const Result whole = fitter.fit(samples);
+
+    const size_t nParticipants = 4;
+    Group group(nParticipants);
+    vector<Result> split(nParticipants);
+    vector<thread> threads;
+    for (size_t p = 0; p < nParticipants; ++p) {
+        threads.push_back(thread([&, p]() {
+            ThreadReducer reducer(group, p);
+            BatchFitter local(fitter);
+            local.setReducer(&reducer);
+            split[p] = local.fit(samples);
+        }));
+    }
+    for (size_t p = 0; p < nParticipants; ++p) {
+        threads[p].join();
+    }
+
+    for (size_t p = 0; p < nParticipants; ++p) {
+        EXPECT_NEAR(whole.rmse, split[p].rmse, 1e-6 * whole.rmse);
+        ASSERT_EQ(whole.poles.size(), split[p].poles.size());
+        for (int i = 0; i < whole.poles.size(); ++i) {
+            EXPECT_NEAR(0.0, abs(whole.poles(i) - split[p].poles(i)),
+                        1e-6 * abs(whole.poles(i)));
+        }
+        EXPECT_EQ(split[0].residues, split[p].residues);
+    }
+}
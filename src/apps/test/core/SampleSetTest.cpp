@@ -0,0 +1,118 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "gtest/gtest.h"
+#include "Generator.h"
+#include "PoleCache.h"
+#include "SampleSet.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class VectorFittingSampleSetTest : public ::testing::Test {
+
+};
+
+TEST_F(VectorFittingSampleSetTest, invariants) {
+    vector<Sample> samples(3, Sample(Complex(0.0, 0.0),
+                                     vector<Complex>(2)));
+    samples[0].first = Complex(0.0, 3.0);
+    samples[1].first = Complex(0.0, 1.0);
+    samples[2].first = Complex(0.0, 2.0);
+    samples[1].second[0] = Complex(3.0, 0.0);
+    samples[2].second[1] = Complex(0.0, 2.0);
+    vector<vector<Real>> weights(3, vector<Real>(2, 1.0));
+    weights[2][1] = 2.0;
+
+    const SampleSet data(samples, weights);
+    EXPECT_EQ(samples, data.getSamples());
+    EXPECT_EQ(Complex(0.0, 1.0), data.getFrequencies()(1));
+    EXPECT_EQ(Complex(3.0, 0.0), data.getResponses()(1,0));
+    EXPECT_EQ(3, data.getSamplesSize());
+    EXPECT_EQ(2, data.getResponseSize());
+    EXPECT_EQ(2.0, data.getWeights()(2,1));
+    EXPECT_EQ(1.0, data.getFrequencyRange().first);
+    EXPECT_EQ(3.0, data.getFrequencyRange().second);
+    EXPECT_DOUBLE_EQ(5.0, data.getWeightedNorm());
+    EXPECT_DOUBLE_EQ(5.0 / 3.0, data.getScale());
+    EXPECT_EQ(PoleCache::hashGrid(samples), data.getGridHash());
+
+    EXPECT_TRUE(SampleSet(samples).getWeights().isOnes());
+    EXPECT_THROW(SampleSet(vector<Sample>()), runtime_error);
+    weights.pop_back();
+    EXPECT_THROW(SampleSet(samples, weights), runtime_error);
+    weights.push_back(vector<Real>(1, 1.0));
+    EXPECT_THROW(SampleSet(samples, weights), runtime_error);
+}
+
+TEST_F(VectorFittingSampleSetTest, shared) {
+    Generator generator(5);
+    generator.setSamplesSize(300);
+    generator.setResponseSize(3);
+    generator.setOrder(8);
+    const vector<Sample> samples = generator.getSamples();
+    const shared_ptr<const SampleSet> data = SampleSet::build(samples);
+    const vector<Complex> poles =
+            VectorFitting::VectorFitting::getStartingPoles(*data, 8);
+    EXPECT_EQ(VectorFitting::VectorFitting::getStartingPoles(samples, 8),
+              poles);
+
+    VectorFitting::VectorFitting copied(samples, poles, Options());
+    copied.fit();
+
+    // Concurrent fitters on the same set, none of them copies it.
+    const long fitters = 4;
+    vector<vector<Complex>> fitted(fitters);
+#pragma omp parallel for
+    for (long f = 0; f < fitters; ++f) {
+        VectorFitting::VectorFitting fitting(data, poles, Options());
+        fitting.fit();
+        fitted[f] = fitting.getPoles();
+        EXPECT_EQ(data.get(), fitting.getSampleSet().get());
+    }
+    EXPECT_EQ(1, data.use_count());
+    EXPECT_EQ(samples, data->getSamples());
+    for (long f = 0; f < fitters; ++f) {
+        EXPECT_EQ(copied.getPoles(), fitted[f]);
+    }
+}
+
+TEST_F(VectorFittingSampleSetTest, parallelCopy) {
+    Generator generator(6);
+    generator.setSamplesSize(50);
+    generator.setResponseSize(7);
+    const vector<Sample> samples = generator.getSamples();
+    vector<vector<Real>> weights(50, vector<Real>(7, 1.0));
+    weights[10][6] = 3.0;
+
+    // More threads than responses leaves some of them idle.
+    const SampleSet serial(samples, weights);
+    for (size_t threads = 2; threads <= 8; threads *= 2) {
+        const SampleSet parallel(samples, weights, threads);
+        EXPECT_EQ(serial.getFrequencies(), parallel.getFrequencies());
+        EXPECT_EQ(serial.getResponses(), parallel.getResponses());
+        EXPECT_EQ(serial.getWeights(), parallel.getWeights());
+        EXPECT_EQ(serial.getGridHash(), parallel.getGridHash());
+    }
+    EXPECT_TRUE(SampleSet(samples, vector<vector<Real>>(), 4)
+            .getWeights().isOnes());
+}
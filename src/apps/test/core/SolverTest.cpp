@@ -0,0 +1,291 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+
+#include "gtest/gtest.h"
+#include "BatchFitter.h"
+#include "Fixtures.h"
+#include "Generator.h"
+#include "Tuning.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class VectorFittingSolverTest : public ::testing::Test {
+protected:
+    static Real fit(const Options::Solver solver, Health& health) {
+        Options opts;
+        opts.setSolver(solver);
+        const vector<Sample> samples = Fixtures::getFdneRow();
+        VectorFitting::VectorFitting fitting(samples, 12, opts,
+                BatchFitter::getWeights(samples,
+                                        BatchFitter::inverseSqrtMagnitude));
+        for (size_t iter = 0; iter < 4; ++iter) {
+            health = fitting.fit().health;
+        }
+        return fitting.getRMSE();
+    }
+};
+
+TEST_F(VectorFittingSolverTest, solvers) {
+    Health qr, normal, pivoting;
+    const Real reference = fit(Options::householder, qr);
+    EXPECT_NEAR(reference, fit(Options::normalEquations, normal),
+                1e-3 * reference);
+    EXPECT_NEAR(reference, fit(Options::columnPivoting, pivoting),
+                1e-6 * reference);
+
+    EXPECT_TRUE(qr.valid);
+    EXPECT_EQ(Options::normalEquations, normal.solver);
+    EXPECT_EQ(0, normal.fallbacks);
+    EXPECT_GE(qr.basisCondition, 1.0);
+    EXPECT_LE(qr.basisCondition, qr.systemCondition);
+    EXPECT_GE(qr.systemCondition, 1.0);
+    EXPECT_GE(qr.reducedCondition, 1.0);
+    EXPECT_GE(qr.escaleSpread, 1.0);
+    EXPECT_GT(qr.sigmaD, 0.0);
+    // Cholesky and Householder factors have the same diagonal up to signs.
+    EXPECT_NEAR(1.0, normal.systemCondition / qr.systemCondition, 1e-2);
+    EXPECT_NEAR(1.0, normal.basisCondition / qr.basisCondition, 1e-2);
+    // Relocation has settled by the fourth iteration.
+    EXPECT_GE(qr.poleMovement, 0.0);
+    EXPECT_LT(qr.poleMovement, 0.1);
+}
+
+TEST_F(VectorFittingSolverTest, policy) {
+    vector<Health> seen;
+    BatchFitter fitter;
+    fitter.setOrders(12, 12);
+    fitter.setIterations(3);
+    fitter.setSolverPolicy([&seen](const Health& previous) {
+        seen.push_back(previous);
+        return previous.valid ? Options::columnPivoting : Options::householder;
+    });
+    const Result result = fitter.fit(Fixtures::getFdneRow());
+
+    EXPECT_EQ(3, seen.size());
+    EXPECT_FALSE(seen[0].valid);
+    EXPECT_EQ(Options::householder, seen[1].solver);
+    EXPECT_EQ(Options::columnPivoting, seen[2].solver);
+    EXPECT_EQ(Options::columnPivoting, result.statistics.health.solver);
+
+    Health healthy;
+    healthy.valid = true;
+    healthy.systemCondition = healthy.reducedCondition = 10.0;
+    healthy.escaleSpread = 10.0;
+    healthy.sigmaD = 1.0;
+    EXPECT_EQ(Options::normalEquations,
+              VectorFitting::VectorFitting::getAdaptiveSolver(healthy));
+    Health singular = healthy;
+    singular.reducedCondition = 1e14;
+    EXPECT_EQ(Options::columnPivoting,
+              VectorFitting::VectorFitting::getAdaptiveSolver(singular));
+    EXPECT_EQ(Options::householder,
+              VectorFitting::VectorFitting::getAdaptiveSolver(Health()));
+}
+
+TEST_F(VectorFittingSolverTest, reproducible) {
+    // Responses that do not fill the last block.
+    Generator generator(3);
+    generator.setSamplesSize(200);
+    generator.setOrder(10);
+    generator.setResponseSize(4 * Options::reproducibleBlockSize + 3);
+    const vector<Sample> samples = generator.getSamples();
+    Options opts;
+    opts.setReproducible(true);
+
+    vector<vector<Complex>> poles;
+    vector<MatrixXcd> residues;
+    const size_t threads[] = {1, 2, 3, 7};
+    for (size_t t = 0; t < 4; ++t) {
+        Tuning tuning;
+        tuning.fitThreads = threads[t];
+        Tuning::set(tuning);
+        VectorFitting::VectorFitting fitting(samples, 10, opts);
+        for (size_t iter = 0; iter < 3; ++iter) {
+            fitting.fit();
+        }
+        poles.push_back(fitting.getPoles());
+        residues.push_back(fitting.getC());
+    }
+    Tuning::set(Tuning());
+
+    for (size_t t = 1; t < poles.size(); ++t) {
+        ASSERT_EQ(poles[0].size(), poles[t].size());
+        for (size_t i = 0; i < poles[0].size(); ++i) {
+            EXPECT_EQ(poles[0][i], poles[t][i]);
+        }
+        EXPECT_TRUE(residues[0] == residues[t]);
+    }
+}
+
+TEST_F(VectorFittingSolverTest, parallelResidues) {
+    // Per element weights, as in ex4a, give each response its own system.
+    Generator generator(6);
+    generator.setSamplesSize(200);
+    generator.setOrder(8);
+    generator.setResponseSize(9);
+    generator.setAsymptoticTrend(Options::linear);
+    const vector<Sample> samples = generator.getSamples();
+    vector<vector<Real>> weights(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        for (size_t n = 0; n < samples[i].second.size(); ++n) {
+            weights[i].push_back(
+                    1.0 / std::sqrt(std::abs(samples[i].second[n])));
+        }
+    }
+    Options opts;
+    opts.setAsymptoticTrend(Options::linear);
+    opts.setSkipPoleIdentification(true);
+
+    vector<MatrixXcd> residues;
+    vector<VectorXcd> constants, linears;
+    const size_t threads[] = {1, 4};
+    for (size_t t = 0; t < 2; ++t) {
+        Tuning tuning;
+        tuning.fitThreads = threads[t];
+        Tuning::set(tuning);
+        VectorFitting::VectorFitting fitting(samples, 8, opts, weights);
+        fitting.fit();
+        residues.push_back(fitting.getC());
+        constants.push_back(fitting.getD());
+        linears.push_back(fitting.getE());
+    }
+    Tuning::set(Tuning());
+
+    EXPECT_TRUE(residues[0] == residues[1]);
+    EXPECT_TRUE(constants[0] == constants[1]);
+    EXPECT_TRUE(linears[0] == linears[1]);
+    EXPECT_NE(0.0, linears[0].norm());
+}
+
+TEST_F(VectorFittingSolverTest, frozenPoles) {
+    Generator generator(7);
+    generator.setSamplesSize(300);
+    generator.setOrder(12);
+    generator.setResponseSize(3);
+    const vector<Sample> samples = generator.getSamples();
+    const Result model = generator.getModel();
+
+    // Two known pairs, frozen first in the starting poles, and the rest
+    // from the default starting poles.
+    vector<Complex> poles(model.poles.data(), model.poles.data() + 4);
+    const vector<Complex> starting =
+            VectorFitting::VectorFitting::getStartingPoles(samples, 8);
+    poles.insert(poles.begin(), starting.begin(), starting.end());
+    vector<bool> frozen(12, false);
+    frozen[0] = frozen[1] = frozen[2] = frozen[3] = true;
+    frozen[4] = true;
+    VectorFitting::VectorFitting fitting(samples, poles, Options());
+    EXPECT_THROW(fitting.setFrozenPoles(frozen), runtime_error);
+    frozen[4] = false;
+    EXPECT_THROW(fitting.setFrozenPoles(vector<bool>(11, false)),
+                 runtime_error);
+    rotate(frozen.begin(), frozen.begin() + 4, frozen.end());
+    fitting.setFrozenPoles(frozen);
+    EXPECT_EQ(4, fitting.getFrozenSize());
+    EXPECT_EQ(poles, fitting.getPoles());
+
+    VectorFitting::VectorFitting full(samples, 12, Options());
+    for (size_t iter = 0; iter < 5; ++iter) {
+        fitting.fit();
+        full.fit();
+    }
+    const vector<Complex> fitted = fitting.getPoles();
+    for (size_t m = 0; m < 4; ++m) {
+        EXPECT_EQ(model.poles(m), fitted[8+m]);
+    }
+    EXPECT_LT(fitting.getRMSE(), 1e-8);
+    EXPECT_LT(full.getRMSE(), 1e-8);
+
+    // Nothing frozen fits as before.
+    VectorFitting::VectorFitting unfrozen(samples, 12, Options());
+    unfrozen.setFrozenPoles(vector<bool>(12, false));
+    VectorFitting::VectorFitting plain(samples, 12, Options());
+    unfrozen.fit();
+    plain.fit();
+    EXPECT_EQ(plain.getPoles(), unfrozen.getPoles());
+    EXPECT_TRUE(plain.getC() == unfrozen.getC());
+}
+
+TEST_F(VectorFittingSolverTest, frozenSystemSizes) {
+    // Frozen poles keep their columns in the left block of each response
+    // system, only sigma, the reduced systems and the eigenproblem shrink.
+    Generator generator(7);
+    generator.setSamplesSize(300);
+    generator.setOrder(12);
+    generator.setResponseSize(3);
+    const vector<Sample> samples = generator.getSamples();
+    const vector<Complex> poles =
+            VectorFitting::VectorFitting::getStartingPoles(samples, 12);
+    vector<bool> frozen(12, false);
+    fill(frozen.begin() + 6, frozen.end(), true);
+
+    VectorFitting::VectorFitting fitting(samples, poles, Options());
+    fitting.setFrozenPoles(frozen);
+    VectorFitting::VectorFitting full(samples, poles, Options());
+    const Statistics partial = fitting.fit();
+    const Statistics all = full.fit();
+
+    EXPECT_LT(partial.flops[Statistics::assembly],
+              all.flops[Statistics::assembly]);
+    EXPECT_LT(partial.flops[Statistics::eigen],
+              0.25 * all.flops[Statistics::eigen]);
+#ifdef CompileWithAllocationTracking
+    EXPECT_LT(partial.allocatedBytes[Statistics::assembly],
+              all.allocatedBytes[Statistics::assembly]);
+#endif
+}
+
+TEST_F(VectorFittingSolverTest, basisReuse) {
+    Generator generator(4);
+    generator.setSamplesSize(300);
+    generator.setOrder(10);
+    generator.setResponseSize(3);
+    generator.setNoise(1e-3);
+    const vector<Sample> samples = generator.getSamples();
+
+    VectorFitting::VectorFitting fitting(samples, 10, Options());
+    EXPECT_EQ(0, fitting.fit().health.reusedColumns);
+    const vector<Complex> poles = fitting.getPoles();
+
+    // Pole identification starts from the poles residue identification
+    // ended with, their columns are all kept and nothing changes.
+    EXPECT_EQ(10, fitting.fit().health.reusedColumns);
+    VectorFitting::VectorFitting fresh(samples, poles, Options());
+    fresh.fit();
+    EXPECT_EQ(fresh.getPoles(), fitting.getPoles());
+    EXPECT_TRUE(fresh.getC() == fitting.getC());
+
+    // Converged poles barely move, a tolerance keeps most of them in place
+    // in residue identification too.
+    Options opts;
+    opts.setBasisTolerance(1e-3);
+    VectorFitting::VectorFitting tolerant(samples, 10, opts);
+    for (size_t iter = 0; iter < 5; ++iter) {
+        fitting.fit();
+        tolerant.fit();
+    }
+    EXPECT_GT(tolerant.getStatistics().health.reusedColumns, 10);
+    EXPECT_NEAR(fitting.getRMSE(), tolerant.getRMSE(),
+                1e-2 * fitting.getRMSE());
+}
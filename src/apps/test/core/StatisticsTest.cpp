@@ -0,0 +1,82 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "gtest/gtest.h"
+#include "BatchFitter.h"
+#include "Fixtures.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class VectorFittingStatisticsTest : public ::testing::Test {
+
+};
+
+TEST_F(VectorFittingStatisticsTest, fit) {
+    Options opts;
+    VectorFitting::VectorFitting fitting(Fixtures::getFdneRow(), 12, opts);
+    const Statistics stats = fitting.fit();
+    EXPECT_EQ(1, stats.iterations);
+#ifndef CompileWithoutStatistics
+    EXPECT_EQ(6, stats.calls[Statistics::assembly]);
+    EXPECT_EQ(6, stats.calls[Statistics::residues]);
+    EXPECT_EQ(2, stats.calls[Statistics::basis]);
+    EXPECT_EQ(0, stats.calls[Statistics::error]);
+    for (size_t p = 0; p < Statistics::numberOfPhases; ++p) {
+        EXPECT_GE(stats.seconds[p], 0.0);
+    }
+    EXPECT_GT(stats.seconds[Statistics::assembly], 0.0);
+    EXPECT_GT(stats.flops[Statistics::assembly],
+              stats.flops[Statistics::solve]);
+    EXPECT_EQ(0.0, stats.flops[Statistics::error]);
+
+    // Every metric comes from a single evaluation.
+    vector<Real> errors;
+    const Result result = fitting.getResult(0, &errors);
+    EXPECT_EQ(1, result.statistics.calls[Statistics::error]);
+    EXPECT_EQ(fitting.getRMSE(), result.rmse);
+    EXPECT_EQ(fitting.getMaxDeviation(), result.maxDeviation);
+    EXPECT_EQ(fitting.getSampleErrors(), errors);
+    EXPECT_GT(result.statistics.flops[Statistics::error], 0.0);
+    EXPECT_EQ(stats.getFlops() + result.statistics.flops[Statistics::error],
+              result.statistics.getFlops());
+#endif
+}
+
+TEST_F(VectorFittingStatisticsTest, batch) {
+    BatchFitter fitter;
+    fitter.setOrders(8, 12, 2);
+    fitter.setIterations(2);
+    const Result result = fitter.fit(Fixtures::getFdneRow());
+    EXPECT_EQ(6, result.statistics.iterations);
+#ifndef CompileWithoutStatistics
+    EXPECT_EQ(6*6, result.statistics.calls[Statistics::assembly]);
+    EXPECT_EQ(6, result.statistics.calls[Statistics::error]);
+    EXPECT_GT(result.statistics.getSeconds(), 0.0);
+#endif
+
+    Statistics sum;
+    sum += result.statistics;
+    sum += result.statistics;
+    EXPECT_EQ(12, sum.iterations);
+    EXPECT_EQ(2.0 * result.statistics.getFlops(), sum.getFlops());
+    EXPECT_STREQ("eigen", Statistics::getName(Statistics::eigen));
+}
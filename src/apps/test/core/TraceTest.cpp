@@ -0,0 +1,145 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "BatchFitter.h"
+#include "Trace.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class VectorFittingTraceTest : public ::testing::Test {
+protected:
+    void SetUp() {
+        Trace::clear();
+    }
+    void TearDown() {
+        Trace::setEnabled(false);
+        Trace::clear();
+    }
+
+    static size_t count(const string& text, const string& pattern) {
+        size_t res = 0;
+        for (size_t pos = text.find(pattern); pos != string::npos;
+                pos = text.find(pattern, pos + 1)) {
+            res++;
+        }
+        return res;
+    }
+};
+
+#ifndef CompileWithoutTracing
+TEST_F(VectorFittingTraceTest, threads) {
+    {
+        Trace::Scope scope("disabled", "test");
+    }
+    EXPECT_EQ(0, Trace::size());
+
+    Trace::setEnabled(true);
+    const size_t nThreads = 4, nEvents = 5000;
+    vector<thread> threads;
+    for (size_t t = 0; t < nThreads; ++t) {
+        threads.push_back(thread([]() {
+            for (size_t i = 0; i < nEvents; ++i) {
+                Trace::Scope scope("event", "test", i);
+            }
+        }));
+    }
+    for (size_t t = 0; t < nThreads; ++t) {
+        threads[t].join();
+    }
+    EXPECT_EQ(nThreads * nEvents, Trace::size());
+
+    stringstream json;
+    Trace::write(json);
+    EXPECT_EQ(nThreads * nEvents, count(json.str(), "\"name\":\"event\""));
+    EXPECT_EQ(0, json.str().find("{\"displayTimeUnit\":\"ms\""));
+
+    Trace::clear();
+    EXPECT_EQ(0, Trace::size());
+}
+
+TEST_F(VectorFittingTraceTest, nested) {
+    Trace::setEnabled(true);
+    {
+        Trace::Scope outer("outer", "test");
+        for (size_t i = 0; i < 3; ++i) {
+            Trace::Scope inner("inner", "test", i);
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    }
+    Trace::setEnabled(false);
+
+    stringstream json;
+    Trace::write(json);
+    const string text = json.str();
+    vector<double> ts, dur;
+    for (size_t pos = text.find("\"ts\":"); pos != string::npos;
+            pos = text.find("\"ts\":", pos + 1)) {
+        ts.push_back(stod(text.substr(pos + 5)));
+        const size_t end = text.find("\"dur\":", pos);
+        dur.push_back(stod(text.substr(end + 6)));
+    }
+    ASSERT_EQ(4, ts.size());
+    // The outer scope is recorded last and spans every other one.
+    const double total = dur.back();
+    EXPECT_EQ(0.0, ts.back());
+    for (size_t i = 0; i < ts.size(); ++i) {
+        EXPECT_GE(ts[i], 0.0);
+        EXPECT_LE(ts[i], total);
+        EXPECT_LE(ts[i] + dur[i], total + 1e-3);
+    }
+}
+
+TEST_F(VectorFittingTraceTest, fit) {
+    vector<Sample> samples;
+    for (size_t k = 1; k <= 100; ++k) {
+        const Complex s(0.0, 10.0 * k);
+        vector<Complex> f(3);
+        for (size_t n = 0; n < f.size(); ++n) {
+            f[n] = Complex(1.0 + n, 2.0) / (s - Complex(-10.0, 300.0))
+                 + Complex(1.0 + n,-2.0) / (s - Complex(-10.0,-300.0));
+        }
+        samples.push_back(Sample(s, f));
+    }
+    Trace::setEnabled(true);
+    BatchFitter fitter;
+    fitter.setOrders(2, 2);
+    fitter.setIterations(2);
+    fitter.fit(samples, 7);
+    Trace::setEnabled(false);
+
+    stringstream json;
+    Trace::write(json);
+    const string text = json.str();
+    EXPECT_EQ(1, count(text, "\"name\":\"job\""));
+    EXPECT_EQ(1, count(text, "\"name\":\"order\""));
+    EXPECT_EQ(2, count(text, "\"name\":\"eigen\""));
+    EXPECT_EQ(2*3, count(text, "\"name\":\"response\""));
+    EXPECT_EQ(2*3, count(text, "\"name\":\"residue\""));
+    EXPECT_EQ(2, count(text, "\"name\":\"error\""));
+    EXPECT_NE(string::npos, text.find("\"args\":{\"id\":7}"));
+}
+#endif
@@ -0,0 +1,95 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <cstdio>
+#include <fstream>
+
+#include "gtest/gtest.h"
+#include "CostModel.h"
+#include "Tuning.h"
+#include "VectorFitting.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+class VectorFittingTuningTest : public ::testing::Test {
+protected:
+    void SetUp() {
+        previous_ = Tuning::get();
+    }
+    void TearDown() {
+        Tuning::set(previous_);
+    }
+private:
+    Tuning previous_;
+};
+
+TEST_F(VectorFittingTuningTest, profile) {
+    Tuning tuning;
+    tuning.fitThreads = 3;
+    tuning.batchThreads = 5;
+    tuning.normalEquationsCondition = 0.0;
+    tuning.flopRate = 2.5e9;
+    tuning.parallelEfficiency = 0.7;
+    tuning.overhead = 3e-6;
+    const string filename = "tuningTest.profile";
+    tuning.write(filename);
+    const Tuning read = Tuning::read(filename);
+    remove(filename.c_str());
+    EXPECT_EQ(3, read.fitThreads);
+    EXPECT_EQ(5, read.batchThreads);
+    EXPECT_EQ(0.0, read.normalEquationsCondition);
+    EXPECT_EQ(tuning.normalEquationsMovement, read.normalEquationsMovement);
+    EXPECT_EQ(2.5e9, read.flopRate);
+    EXPECT_EQ(0.7, read.parallelEfficiency);
+    EXPECT_EQ(3e-6, read.overhead);
+
+    {
+        ofstream file(filename.c_str());
+        file << "# comment" << endl << "fitThreads = 2" << endl
+             << "threads = 4" << endl;
+    }
+    EXPECT_THROW(Tuning::read(filename), runtime_error);
+    remove(filename.c_str());
+}
+
+TEST_F(VectorFittingTuningTest, defaults) {
+    Health health;
+    health.valid = true;
+    health.systemCondition = 10.0;
+    health.reducedCondition = 10.0;
+    health.escaleSpread = 10.0;
+    health.sigmaD = 1.0;
+    health.poleMovement = 1e-4;
+
+    Tuning::set(Tuning());
+    EXPECT_EQ(Options::normalEquations,
+              VectorFitting::VectorFitting::getAdaptiveSolver(health));
+
+    Tuning tuning;
+    tuning.normalEquationsCondition = 0.0;
+    tuning.flopRate = 4e9;
+    Tuning::set(tuning);
+    EXPECT_EQ(Options::householder,
+              VectorFitting::VectorFitting::getAdaptiveSolver(health));
+    EXPECT_EQ(4e9, CostModel().getFlopRate());
+}
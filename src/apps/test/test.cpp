@@ -22,9 +22,13 @@
 #include <gtest/gtest.h>
 #include <string>
 
+#include "Tuning.h"
+
 using namespace std;
 
 GTEST_API_ int main(int argc, char **argv) {
+  // Expectations hold for the built-in defaults, not for the host profile.
+  VectorFitting::Tuning::set(VectorFitting::Tuning());
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
 }
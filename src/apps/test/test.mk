@@ -20,6 +20,10 @@
 # along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
 
 OUT = test
+# Tests count heap allocations, see Allocation.h. Objects are kept apart
+# from the ones of the tools, which are built without it.
+DEFINES += CompileWithAllocationTracking
+OBJ_DIR := $(OBJ_DIR)test/
 # =============================================================================
 SRC_APP_DIR = $(SRC_DIR)apps/test/
 # =============================================================================
@@ -0,0 +1,120 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifdef CompileWithMPI
+
+#include "MPIReducer.h"
+#include "VectorFitting.h"
+
+#include <vector>
+
+namespace VectorFitting {
+
+using namespace Eigen;
+
+MPIReducer::MPIReducer(MPI_Comm comm)
+:   comm_(comm) {
+    MPI_Comm_rank(comm_, &rank_);
+    MPI_Comm_size(comm_, &size_);
+}
+
+MPIReducer::~MPIReducer() {
+}
+
+std::pair<std::size_t, std::size_t> MPIReducer::getResponseRange(
+        const std::size_t Nc) const {
+    return getResponseRange(Nc, rank_);
+}
+
+std::pair<std::size_t, std::size_t> MPIReducer::getResponseRange(
+        const std::size_t Nc, const int rank) const {
+    return std::pair<std::size_t, std::size_t>(
+            Nc * (std::size_t)  rank      / (std::size_t) size_,
+            Nc * (std::size_t) (rank + 1) / (std::size_t) size_);
+}
+
+void MPIReducer::reduce(MatrixXd& R, VectorXd& b) {
+    // Every rank holds a square factor, see VectorFitting::fit().
+    const int M = (int) R.cols();
+    const int count = M*M + M;
+    std::vector<double> buffer(count);
+    for (int step = 1; step < size_; step *= 2) {
+        if (rank_ % (2*step) == 0) {
+            const int source = rank_ + step;
+            if (source < size_) {
+                MPI_Recv(&buffer[0], count, MPI_DOUBLE, source, 0, comm_,
+                         MPI_STATUS_IGNORE);
+                merge(R, b, Map<MatrixXd>(&buffer[0], M, M),
+                            Map<VectorXd>(&buffer[M*M], M));
+            }
+        } else {
+            Map<MatrixXd>(&buffer[0], M, M) = R;
+            Map<VectorXd>(&buffer[M*M], M) = b;
+            MPI_Send(&buffer[0], count, MPI_DOUBLE, rank_ - step, 0, comm_);
+            break;
+        }
+    }
+    if (rank_ == 0) {
+        Map<MatrixXd>(&buffer[0], M, M) = R;
+        Map<VectorXd>(&buffer[M*M], M) = b;
+    }
+    MPI_Bcast(&buffer[0], count, MPI_DOUBLE, 0, comm_);
+    R = Map<MatrixXd>(&buffer[0], M, M);
+    b = Map<VectorXd>(&buffer[M*M], M);
+}
+
+void MPIReducer::gather(MatrixXcd& C, VectorXcd& D, VectorXcd& E) {
+    // Each response travels as its row of C followed by D and E.
+    const std::size_t Nc = C.rows();
+    const std::size_t N  = C.cols();
+    const int stride = 2 * (int) (N + 2);
+    std::vector<int> counts(size_), displacements(size_);
+    for (int p = 0; p < size_; ++p) {
+        const std::pair<std::size_t, std::size_t> range =
+                getResponseRange(Nc, p);
+        counts[p] = stride * (int) (range.second - range.first);
+        displacements[p] = stride * (int) range.first;
+    }
+    std::vector<Complex> local, global(Nc * (N + 2));
+    const std::pair<std::size_t, std::size_t> range = getResponseRange(Nc);
+    for (std::size_t n = range.first; n < range.second; ++n) {
+        for (std::size_t i = 0; i < N; ++i) {
+            local.push_back(C(n,i));
+        }
+        local.push_back(D(n));
+        local.push_back(E(n));
+    }
+    MPI_Allgatherv(local.empty() ? NULL : &local[0], counts[rank_],
+                   MPI_DOUBLE, &global[0], &counts[0], &displacements[0],
+                   MPI_DOUBLE, comm_);
+    for (std::size_t n = 0; n < Nc; ++n) {
+        const Complex* row = &global[n * (N + 2)];
+        for (std::size_t i = 0; i < N; ++i) {
+            C(n,i) = row[i];
+        }
+        D(n) = row[N];
+        E(n) = row[N+1];
+    }
+}
+
+} /* namespace VectorFitting */
+
+#endif /* CompileWithMPI */
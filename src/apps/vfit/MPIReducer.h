@@ -0,0 +1,63 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEMBA_VECTOR_FITTING_MPIREDUCER_H_
+#define SEMBA_VECTOR_FITTING_MPIREDUCER_H_
+
+#ifdef CompileWithMPI
+
+#include <mpi.h>
+
+#include "Reducer.h"
+
+namespace VectorFitting {
+
+/**
+ * Splits each fit among the ranks of a communicator. Responses are given in
+ * contiguous blocks, triangular factors are merged along a binomial tree
+ * rooted at rank 0 and broadcast, and residues are all-gathered.
+ */
+class MPIReducer : public Reducer {
+public:
+    MPIReducer(MPI_Comm comm = MPI_COMM_WORLD);
+    virtual ~MPIReducer();
+
+    int getRank() const { return rank_; }
+    int getSize() const { return size_; }
+
+    std::pair<std::size_t, std::size_t> getResponseRange(
+            const std::size_t Nc) const;
+    void reduce(Eigen::MatrixXd& R, Eigen::VectorXd& b);
+    void gather(Eigen::MatrixXcd& C, Eigen::VectorXcd& D, Eigen::VectorXcd& E);
+
+private:
+    MPI_Comm comm_;
+    int rank_, size_;
+
+    std::pair<std::size_t, std::size_t> getResponseRange(
+            const std::size_t Nc, const int rank) const;
+};
+
+} /* namespace VectorFitting */
+
+#endif /* CompileWithMPI */
+
+#endif /* SEMBA_VECTOR_FITTING_MPIREDUCER_H_ */
@@ -0,0 +1,518 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BatchFitter.h"
+#include "Counters.h"
+#include "Exporter.h"
+#include "Importer.h"
+#include "Trace.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef CompileWithMPI
+#include <sstream>
+#include "MPIReducer.h"
+#endif
+
+using namespace VectorFitting;
+using namespace std;
+
+namespace {
+
+struct Arguments {
+    vector<string> inputs;
+    string output = "models.vfm";
+    string report;
+    string statistics;
+    string trace;
+    Exporter::Format outputFormat = Exporter::binary;
+    Importer::Format inputFormat = Importer::automatic;
+    size_t minOrder = 10, maxOrder = 10, orderStep = 2;
+    Real targetRMSE = 0.0;
+    size_t iterations = 5;
+    bool refine = false;
+    bool counters = false;
+    BatchFitter::Weighting weighting = BatchFitter::uniform;
+    Options::AsymptoticTrend trend = Options::constant;
+    Options::Solver solver = Options::householder;
+    bool adaptive = false;
+    size_t threads = 0;
+    bool split = false;
+};
+
+// Rank of this process, there is a single one without MPI.
+size_t myRank = 0, nRanks = 1;
+
+void printUsage() {
+    cout << "Usage: vfit [options] file..." << endl
+         << "Fits every input file and writes all models to one store." << endl
+         << endl
+         << "  -o, --output FILE         Model store (models.vfm)." << endl
+         << "  -r, --report FILE         Per-file metrics (stdout)." << endl
+         << "  -s, --statistics FILE     Per-file time in each fit phase."
+         << endl
+         << "      --counters            Adds hardware counters to the"
+         << " statistics," << endl
+         << "                            '-' where perf events are refused."
+         << endl
+         << "      --trace FILE          Chrome trace of the run, one per rank."
+         << endl
+         << "  -f, --format FMT          binary | text (binary)." << endl
+         << "  -i, --input-format FMT    auto | fdne | touchstone | binary"
+         << " (auto)." << endl
+         << "      --order N             Fixed even order." << endl
+         << "      --min-order N         Lowest order to try (10)." << endl
+         << "      --max-order N         Highest order to try (10)." << endl
+         << "      --order-step N        Even order increment (2)." << endl
+         << "      --target-rmse R       Stop the order search at R (0)."
+         << endl
+         << "  -n, --iterations N        Relocation iterations (5)." << endl
+         << "      --refine              Each order adds poles where the"
+         << endl
+         << "                            previous one fitted worst." << endl
+         << "  -w, --weighting W         uniform | sqrt | inverse"
+         << " (uniform)." << endl
+         << "      --trend T             zero | constant | linear"
+         << " (constant)." << endl
+         << "      --solver S            qr | normal | pivoting | adaptive"
+         << " (qr)." << endl
+         << "  -t, --threads N           Parallel fits, 0 for all cores (0)."
+         << endl
+#ifdef CompileWithMPI
+         << "      --split               Every rank takes part in every fit,"
+         << endl
+         << "                            instead of fitting its own files."
+         << endl
+#endif
+         << "  -h, --help                Shows this message." << endl;
+}
+
+size_t toSize(const string& value) {
+    char* end;
+    const long res = strtol(value.c_str(), &end, 10);
+    if (*end != '\0' || res < 0) {
+        throw runtime_error("Invalid number: " + value);
+    }
+    return (size_t) res;
+}
+
+Arguments parse(int argc, char** argv) {
+    Arguments args;
+    for (int i = 1; i < argc; ++i) {
+        const string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            exit(EXIT_SUCCESS);
+        }
+        if (arg.empty() || arg[0] != '-') {
+            args.inputs.push_back(arg);
+            continue;
+        }
+        if (arg == "--refine") {
+            args.refine = true;
+            continue;
+        }
+        if (arg == "--counters") {
+            args.counters = true;
+            continue;
+        }
+        if (arg == "--split") {
+#ifdef CompileWithMPI
+            args.split = true;
+            continue;
+#else
+            throw runtime_error("--split needs the MPI build, vfitmpi");
+#endif
+        }
+        if (i + 1 >= argc) {
+            throw runtime_error("Missing value for " + arg);
+        }
+        const string value = argv[++i];
+        if (arg == "-o" || arg == "--output") {
+            args.output = value;
+        } else if (arg == "-r" || arg == "--report") {
+            args.report = value;
+        } else if (arg == "-s" || arg == "--statistics") {
+            args.statistics = value;
+        } else if (arg == "--trace") {
+            args.trace = value;
+        } else if (arg == "-f" || arg == "--format") {
+            if      (value == "binary") args.outputFormat = Exporter::binary;
+            else if (value == "text"  ) args.outputFormat = Exporter::text;
+            else throw runtime_error("Unknown output format: " + value);
+        } else if (arg == "-i" || arg == "--input-format") {
+            if      (value == "auto"      ) args.inputFormat = Importer::automatic;
+            else if (value == "fdne"      ) args.inputFormat = Importer::fdne;
+            else if (value == "touchstone") args.inputFormat = Importer::touchstone;
+            else if (value == "binary"    ) args.inputFormat = Importer::binary;
+            else throw runtime_error("Unknown input format: " + value);
+        } else if (arg == "--order") {
+            args.minOrder = args.maxOrder = toSize(value);
+        } else if (arg == "--min-order") {
+            args.minOrder = toSize(value);
+        } else if (arg == "--max-order") {
+            args.maxOrder = toSize(value);
+        } else if (arg == "--order-step") {
+            args.orderStep = toSize(value);
+        } else if (arg == "--target-rmse") {
+            args.targetRMSE = atof(value.c_str());
+        } else if (arg == "-n" || arg == "--iterations") {
+            args.iterations = toSize(value);
+        } else if (arg == "-w" || arg == "--weighting") {
+            if      (value == "uniform") args.weighting = BatchFitter::uniform;
+            else if (value == "sqrt"   ) args.weighting = BatchFitter::inverseSqrtMagnitude;
+            else if (value == "inverse") args.weighting = BatchFitter::inverseMagnitude;
+            else throw runtime_error("Unknown weighting: " + value);
+        } else if (arg == "--trend") {
+            if      (value == "zero"    ) args.trend = Options::zero;
+            else if (value == "constant") args.trend = Options::constant;
+            else if (value == "linear"  ) args.trend = Options::linear;
+            else throw runtime_error("Unknown trend: " + value);
+        } else if (arg == "--solver") {
+            args.adaptive = value == "adaptive";
+            if      (value == "qr"      ) args.solver = Options::householder;
+            else if (value == "normal"  ) args.solver = Options::normalEquations;
+            else if (value == "pivoting") args.solver = Options::columnPivoting;
+            else if (!args.adaptive) throw runtime_error("Unknown solver: " + value);
+        } else if (arg == "-t" || arg == "--threads") {
+            args.threads = toSize(value);
+        } else {
+            throw runtime_error("Unknown option: " + arg);
+        }
+    }
+    if (args.inputs.empty()) {
+        throw runtime_error("No input files");
+    }
+    return args;
+}
+
+int getNumThreads(const size_t threads) {
+    if (threads != 0) {
+        return (int) threads;
+    }
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+struct Report {
+    string status = "ok";
+    size_t Ns = 0, Nc = 0;
+    double seconds = 0.0;
+};
+
+// Records a trace while alive and writes it, if requested, however run()
+// returns.
+class TraceWriter {
+public:
+    TraceWriter(const string& filename) : filename_(filename) {
+        Trace::setEnabled(!filename_.empty());
+    }
+    ~TraceWriter() {
+        if (filename_.empty()) {
+            return;
+        }
+        Trace::setEnabled(false);
+        string filename = filename_;
+        if (nRanks > 1) {
+            filename += "." + to_string(myRank);
+        }
+        try {
+            Trace::write(filename);
+        } catch (const exception& e) {
+            cerr << "vfit: " << e.what() << endl;
+        }
+    }
+private:
+    const string filename_;
+};
+
+#ifdef CompileWithMPI
+// Sends the outcome of the files fitted by this rank to rank 0, which
+// stores it along its own.
+void gatherToRoot(vector<Result>& models,
+                  vector<Report>& reports,
+                  vector<char>& fitted) {
+    ostringstream output(ios::binary);
+    for (size_t i = myRank; i < models.size(); i += nRanks) {
+        const uint64_t header[4] = {
+                (uint64_t) fitted[i], reports[i].Ns, reports[i].Nc,
+                reports[i].status.size()};
+        output.write(reinterpret_cast<const char*>(header), sizeof(header));
+        output.write(reinterpret_cast<const char*>(&reports[i].seconds),
+                     sizeof(double));
+        output.write(reports[i].status.data(), reports[i].status.size());
+        if (fitted[i]) {
+            Exporter::writeModel(output, models[i]);
+            output.write(reinterpret_cast<const char*>(&models[i].statistics),
+                         sizeof(Statistics));
+        }
+    }
+    const string local = output.str();
+    int size = (int) local.size();
+    vector<int> sizes(nRanks), displacements(nRanks);
+    MPI_Gather(&size, 1, MPI_INT, &sizes[0], 1, MPI_INT, 0, MPI_COMM_WORLD);
+    string all;
+    if (myRank == 0) {
+        for (size_t p = 1; p < nRanks; ++p) {
+            displacements[p] = displacements[p-1] + sizes[p-1];
+        }
+        all.resize(displacements.back() + sizes.back());
+    }
+    MPI_Gatherv(const_cast<char*>(local.data()), size, MPI_CHAR,
+                all.empty() ? NULL : &all[0], &sizes[0], &displacements[0],
+                MPI_CHAR, 0, MPI_COMM_WORLD);
+    if (myRank != 0) {
+        return;
+    }
+    for (size_t p = 1; p < nRanks; ++p) {
+        istringstream input(all.substr(displacements[p], sizes[p]),
+                            ios::binary);
+        for (size_t i = p; i < models.size(); i += nRanks) {
+            uint64_t header[4];
+            input.read(reinterpret_cast<char*>(header), sizeof(header));
+            input.read(reinterpret_cast<char*>(&reports[i].seconds),
+                       sizeof(double));
+            fitted[i] = (char) header[0];
+            reports[i].Ns = (size_t) header[1];
+            reports[i].Nc = (size_t) header[2];
+            reports[i].status.resize((size_t) header[3]);
+            input.read(&reports[i].status[0], (size_t) header[3]);
+            if (fitted[i]) {
+                models[i] = Importer::readModel(input);
+                input.read(reinterpret_cast<char*>(&models[i].statistics),
+                           sizeof(Statistics));
+            }
+        }
+    }
+}
+#endif
+
+// A tab separated column, "-" when not counted.
+template<typename T>
+void writeColumn(ostream& out, const bool counted, const T& value) {
+    out << "\t";
+    if (counted) {
+        out << value;
+    } else {
+        out << "-";
+    }
+}
+
+// Counter columns of a phase, "-" for events not counted on this host.
+void writeCounters(ostream& out, const Statistics& stats,
+                   const Statistics::Phase phase, const bool counted) {
+    bool available[Counters::numberOfEvents];
+    for (int e = 0; e < Counters::numberOfEvents; ++e) {
+        available[e] = counted && Counters::isAvailable((Counters::Event) e);
+    }
+    const uint64_t* counters = stats.counters[phase];
+    writeColumn(out, available[Counters::cycles], counters[Counters::cycles]);
+    writeColumn(out, available[Counters::instructions],
+                counters[Counters::instructions]);
+    writeColumn(out, available[Counters::cycles] &&
+                     available[Counters::instructions],
+                stats.getIPC(phase));
+    writeColumn(out, available[Counters::cacheMisses],
+                counters[Counters::cacheMisses]);
+    writeColumn(out, available[Counters::cacheReferences] &&
+                     available[Counters::cacheMisses],
+                stats.getCacheMissRate(phase));
+    writeColumn(out, available[Counters::floatingPoint],
+                counters[Counters::floatingPoint]);
+}
+
+} /* namespace */
+
+int run(int argc, char** argv) {
+    Arguments args;
+    BatchFitter fitter;
+    // Files sampled on the same grid share their first basis.
+    BasisCache basisCache;
+    try {
+        args = parse(argc, argv);
+        Options opts;
+        opts.setAsymptoticTrend(args.trend);
+        opts.setSolver(args.solver);
+        fitter.setOptions(opts);
+        if (args.adaptive) {
+            fitter.setSolverPolicy(VectorFitting::VectorFitting::getAdaptiveSolver);
+        }
+        fitter.setOrders(args.minOrder, args.maxOrder, args.orderStep);
+        fitter.setTargetRMSE(args.targetRMSE);
+        fitter.setIterations(args.iterations);
+        fitter.setRefinement(args.refine);
+        Counters::setEnabled(args.counters);
+        fitter.setWeighting(args.weighting);
+        fitter.setThreads(args.threads);
+        fitter.setBasisCache(&basisCache);
+    } catch (const exception& e) {
+        if (myRank == 0) {
+            cerr << "vfit: " << e.what() << endl;
+            printUsage();
+        }
+        return EXIT_FAILURE;
+    }
+
+    // Without --split files are dealt round-robin among the ranks.
+#ifdef CompileWithMPI
+    MPIReducer reducer;
+    if (args.split) {
+        fitter.setReducer(&reducer);
+    }
+#endif
+    const bool split = args.split;
+    TraceWriter traceWriter(args.trace);
+
+    const size_t nFiles = args.inputs.size();
+    vector<Result> models(nFiles);
+    vector<Report> reports(nFiles);
+    vector<char> fitted(nFiles, false);
+
+    // Files are read inside the loop so that I/O overlaps with other fits.
+#pragma omp parallel for schedule(dynamic) if (!split) \
+        num_threads(getNumThreads(args.threads))
+    for (long i = 0; i < (long) nFiles; ++i) {
+        if (!split && (size_t) i % nRanks != myRank) {
+            continue;
+        }
+        const chrono::steady_clock::time_point start =
+                chrono::steady_clock::now();
+        try {
+            vector<Sample> samples =
+                    Importer::readSamples(args.inputs[i], args.inputFormat);
+            reports[i].Ns = samples.size();
+            reports[i].Nc = samples.empty() ? 0 : samples.front().second.size();
+            models[i] = fitter.fit(samples, (size_t) i);
+            fitted[i] = true;
+        } catch (const exception& e) {
+            reports[i].status = e.what();
+        }
+        reports[i].seconds = chrono::duration<double>(
+                chrono::steady_clock::now() - start).count();
+    }
+
+#ifdef CompileWithMPI
+    if (!split) {
+        gatherToRoot(models, reports, fitted);
+    }
+#endif
+    if (myRank != 0) {
+        return EXIT_SUCCESS;
+    }
+
+    vector<Result> store;
+    for (size_t i = 0; i < nFiles; ++i) {
+        if (fitted[i]) {
+            store.push_back(models[i]);
+        }
+    }
+    try {
+        Exporter::writeModels(args.output, store, args.outputFormat);
+    } catch (const exception& e) {
+        cerr << "vfit: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    ofstream reportFile;
+    if (!args.report.empty()) {
+        reportFile.open(args.report.c_str());
+        if (!reportFile.is_open()) {
+            cerr << "vfit: unable to open " << args.report << endl;
+            return EXIT_FAILURE;
+        }
+    }
+    ostream& out = args.report.empty() ? cout : reportFile;
+    out << "# id\tfile\tNs\tNc\torder\trmse\tmaxDeviation\tseconds\tstatus"
+        << endl;
+    size_t nFailed = 0;
+    for (size_t i = 0; i < nFiles; ++i) {
+        out << i << "\t" << args.inputs[i] << "\t"
+            << reports[i].Ns << "\t" << reports[i].Nc << "\t";
+        if (fitted[i]) {
+            out << models[i].poles.size() << "\t"
+                << models[i].rmse << "\t" << models[i].maxDeviation;
+        } else {
+            out << "-\t-\t-";
+            nFailed++;
+        }
+        out << "\t" << reports[i].seconds << "\t" << reports[i].status << endl;
+    }
+
+    if (!args.statistics.empty()) {
+        ofstream statistics(args.statistics.c_str());
+        if (!statistics.is_open()) {
+            cerr << "vfit: unable to open " << args.statistics << endl;
+            return EXIT_FAILURE;
+        }
+        statistics << "# id\tfile\titerations\tphase\tcalls\tseconds\tflops"
+                   << "\tallocations\tallocatedBytes\tpeakBytes"
+                   << "\tcycles\tinstructions\tipc\tcacheMisses"
+                   << "\tcacheMissRate\tfloatingPoint" << endl;
+        for (size_t i = 0; i < nFiles; ++i) {
+            if (!fitted[i]) {
+                continue;
+            }
+            const Statistics& stats = models[i].statistics;
+            for (size_t p = 0; p < Statistics::numberOfPhases; ++p) {
+                statistics << i << "\t" << args.inputs[i] << "\t"
+                           << stats.iterations << "\t"
+                           << Statistics::getName((Statistics::Phase) p) << "\t"
+                           << stats.calls[p] << "\t" << stats.seconds[p] << "\t"
+                           << stats.flops[p] << "\t" << stats.allocations[p]
+                           << "\t" << stats.allocatedBytes[p] << "\t"
+                           << stats.peakBytes[p];
+                writeCounters(statistics, stats, (Statistics::Phase) p,
+                              args.counters);
+                statistics << endl;
+            }
+        }
+    }
+    return nFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char** argv) {
+#ifdef CompileWithMPI
+    int provided, mpiRank, mpiSize;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpiRank);
+    MPI_Comm_size(MPI_COMM_WORLD, &mpiSize);
+    myRank = (size_t) mpiRank;
+    nRanks = (size_t) mpiSize;
+    const int res = run(argc, argv);
+    MPI_Finalize();
+    return res;
+#else
+    return run(argc, argv);
+#endif
+}
@@ -0,0 +1,341 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Protocol.h"
+#include "SpaceGenerator.h"
+#include "Tuning.h"
+
+using namespace VectorFitting;
+using namespace std;
+
+namespace {
+
+// Guards against reading garbage, or a hostile client, as a frame size.
+// Set once from the command line, before any connection is served.
+uint64_t maxFrameSize = uint64_t(256) << 20;
+
+// Returns false if the stream ends before the first byte.
+bool readAll(int fd, char* buffer, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        const ssize_t n = ::read(fd, buffer + done, size - done);
+        if (n == 0) {
+            if (done == 0) {
+                return false;
+            }
+            throw runtime_error("Truncated frame");
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw runtime_error(strerror(errno));
+        }
+        done += (size_t) n;
+    }
+    return true;
+}
+
+void writeAll(int fd, const char* buffer, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        const ssize_t n = ::write(fd, buffer + done, size - done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw runtime_error(strerror(errno));
+        }
+        done += (size_t) n;
+    }
+}
+
+bool readFrame(int fd, string& payload) {
+    uint64_t size;
+    if (!readAll(fd, reinterpret_cast<char*>(&size), sizeof(size))) {
+        return false;
+    }
+    if (size > maxFrameSize) {
+        throw runtime_error("Frame too large");
+    }
+    // Nothing shorter decodes as a request.
+    if (size < Protocol::requestHeaderSize) {
+        throw runtime_error("Frame too small");
+    }
+    payload.resize((size_t) size);
+    if (size > 0 && !readAll(fd, &payload[0], (size_t) size)) {
+        throw runtime_error("Truncated frame");
+    }
+    return true;
+}
+
+void writeFrame(int fd, const string& payload) {
+    const uint64_t size = payload.size();
+    writeAll(fd, reinterpret_cast<const char*>(&size), sizeof(size));
+    writeAll(fd, payload.data(), payload.size());
+}
+
+Protocol::Response process(const string& payload, PoleCache& cache,
+                           BasisCache& basisCache) {
+    Protocol::Response res;
+    try {
+        Protocol::Request request = Protocol::decodeRequest(payload);
+        res.id = request.id;
+        BatchFitter fitter = Protocol::getFitter(request);
+        fitter.setPoleCache(&cache);
+        fitter.setBasisCache(&basisCache);
+        res.model = fitter.fit(request.samples, request.id);
+        res.ok = true;
+    } catch (const exception& e) {
+        res.ok = false;
+        res.error = e.what();
+    }
+    return res;
+}
+
+// Answers requests from one connection, one at a time, until it closes.
+void serve(int in, int out, PoleCache& cache, BasisCache& basisCache) {
+    try {
+        string payload;
+        while (readFrame(in, payload)) {
+            writeFrame(out, Protocol::encode(
+                    process(payload, cache, basisCache)));
+        }
+    } catch (const exception& e) {
+        cerr << "vfitd: " << e.what() << endl;
+    }
+}
+
+// A first small fit brings up the OpenMP pool and the allocator arenas of
+// the calling thread before the first request arrives.
+void warmUp() {
+    vector<Real> w = linspace(pair<Real,Real>(1.0, 1e3), 64);
+    vector<Sample> samples(w.size());
+    for (size_t k = 0; k < w.size(); ++k) {
+        const Complex s(0.0, w[k]);
+        samples[k] = Sample(s, vector<Complex>(1,
+                Complex(1.0, 2.0) / (s - Complex(-10.0, 300.0))
+              + Complex(1.0,-2.0) / (s - Complex(-10.0,-300.0))));
+    }
+    BatchFitter fitter;
+    fitter.setOrders(2, 2);
+    fitter.setIterations(2);
+    fitter.fit(samples);
+}
+
+// Accepted connections waiting for a worker.
+class Connections {
+public:
+    Connections() : closed_(false) {}
+
+    void push(int client) {
+        {
+            lock_guard<mutex> lock(mutex_);
+            clients_.push_back(client);
+        }
+        ready_.notify_one();
+    }
+
+    // Returns -1 once closed and drained.
+    int pop() {
+        unique_lock<mutex> lock(mutex_);
+        ready_.wait(lock, [this]() {return closed_ || !clients_.empty();});
+        if (clients_.empty()) {
+            return -1;
+        }
+        const int client = clients_.front();
+        clients_.pop_front();
+        return client;
+    }
+
+    void close() {
+        {
+            lock_guard<mutex> lock(mutex_);
+            closed_ = true;
+        }
+        ready_.notify_all();
+    }
+
+private:
+    mutex mutex_;
+    condition_variable ready_;
+    deque<int> clients_;
+    bool closed_;
+};
+
+// Serves connections for the lifetime of the daemon. Each worker keeps its
+// own OpenMP pool, so it is warmed up once instead of per connection.
+void work(Connections& connections, PoleCache& cache,
+          BasisCache& basisCache) {
+    warmUp();
+    int client;
+    while ((client = connections.pop()) >= 0) {
+        serve(client, client, cache, basisCache);
+        close(client);
+    }
+}
+
+size_t toSize(const string& value) {
+    char* end;
+    const long res = strtol(value.c_str(), &end, 10);
+    if (end == value.c_str() || *end != '\0' || res < 0) {
+        throw runtime_error("Invalid number: " + value);
+    }
+    return (size_t) res;
+}
+
+void printUsage() {
+    cout << "Usage: vfitd [options]" << endl
+         << "Serves fit requests framed as size and payload, see Protocol.h."
+         << endl << endl
+         << "  -s, --socket PATH    Listens on a Unix domain socket instead"
+         << " of stdin/stdout." << endl
+         << "  -t, --threads N      OpenMP threads for the fits." << endl
+         << "  -w, --workers N      Connections served at once (4)." << endl
+         << "  -c, --cache N        Warm-start poles kept (1024)." << endl
+         << "  -b, --basis-cache N  MiB of shared basis matrices (256)."
+         << endl
+         << "  -f, --max-frame N    MiB of the largest request (256)."
+         << endl
+         << "  -h, --help           Shows this message." << endl;
+}
+
+} /* namespace */
+
+int main(int argc, char** argv) {
+    string socketPath;
+    size_t cacheSize = 1024;
+    size_t basisCacheSize = 256;
+    size_t workers = 4;
+    Tuning tuning = Tuning::get();
+    for (int i = 1; i < argc; ++i) {
+        const string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return EXIT_SUCCESS;
+        }
+        if (i + 1 >= argc) {
+            cerr << "vfitd: missing value for " << arg << endl;
+            return EXIT_FAILURE;
+        }
+        const string value = argv[++i];
+        try {
+            if (arg == "-s" || arg == "--socket") {
+                socketPath = value;
+            } else if (arg == "-t" || arg == "--threads") {
+                // Fits run on the workers, which only see the profile.
+                tuning.fitThreads = tuning.batchThreads = toSize(value);
+            } else if (arg == "-w" || arg == "--workers") {
+                workers = toSize(value);
+            } else if (arg == "-c" || arg == "--cache") {
+                cacheSize = toSize(value);
+            } else if (arg == "-b" || arg == "--basis-cache") {
+                basisCacheSize = toSize(value);
+            } else if (arg == "-f" || arg == "--max-frame") {
+                const size_t mebibytes = toSize(value);
+                if (mebibytes == 0 || mebibytes > (1 << 16)) {
+                    throw runtime_error("Invalid frame size: " + value);
+                }
+                maxFrameSize = (uint64_t) mebibytes << 20;
+            } else {
+                cerr << "vfitd: unknown option " << arg << endl;
+                printUsage();
+                return EXIT_FAILURE;
+            }
+        } catch (const exception& e) {
+            cerr << "vfitd: " << e.what() << endl;
+            return EXIT_FAILURE;
+        }
+    }
+    Tuning::set(tuning);
+
+    signal(SIGPIPE, SIG_IGN);
+    PoleCache cache(cacheSize == 0 ? 1 : cacheSize);
+    BasisCache basisCache((basisCacheSize == 0 ? 1 : basisCacheSize) << 20);
+
+    if (socketPath.empty()) {
+        warmUp();
+        serve(STDIN_FILENO, STDOUT_FILENO, cache, basisCache);
+        return EXIT_SUCCESS;
+    }
+
+    const int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0) {
+        cerr << "vfitd: " << strerror(errno) << endl;
+        return EXIT_FAILURE;
+    }
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        cerr << "vfitd: socket path too long" << endl;
+        return EXIT_FAILURE;
+    }
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path)-1);
+    unlink(socketPath.c_str());
+    if (bind(server, (sockaddr*) &address, sizeof(address)) < 0
+            || listen(server, SOMAXCONN) < 0) {
+        cerr << "vfitd: " << strerror(errno) << endl;
+        return EXIT_FAILURE;
+    }
+    Connections connections;
+    vector<thread> pool;
+    for (size_t w = 0; w < max<size_t>(workers, 1); ++w) {
+        pool.push_back(thread(work, ref(connections), ref(cache),
+                              ref(basisCache)));
+    }
+    while (true) {
+        const int client = accept(server, NULL, NULL);
+        if (client < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            cerr << "vfitd: " << strerror(errno) << endl;
+            break;
+        }
+        connections.push(client);
+    }
+    // Lets the workers finish the connections already accepted.
+    connections.close();
+    for (size_t w = 0; w < pool.size(); ++w) {
+        pool[w].join();
+    }
+    close(server);
+    unlink(socketPath.c_str());
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,271 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+// Measures this host and writes the tuning profile the library loads at
+// startup, see Tuning.h. Takes about a minute; run it once per node type,
+// on an otherwise idle node.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+#include "BatchFitter.h"
+#include "CostModel.h"
+#include "Generator.h"
+#include "Tuning.h"
+#include "VectorFitting.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace VectorFitting;
+using namespace std;
+
+namespace {
+
+struct Arguments {
+    string output;
+    size_t maxThreads = 0;
+    // Runs are taken as equal within this fraction of the fastest one, the
+    // fewest threads or the simplest solver wins then.
+    double tolerance = 0.05;
+};
+
+void printUsage() {
+    cout << "Usage: vfittune [options]" << endl
+         << "Benchmarks the fitting kernels on this host and writes a"
+         << endl
+         << "tuning profile with the best defaults." << endl
+         << endl
+         << "  -o, --output FILE         Profile ($VECTORFITTING_TUNING or"
+         << endl
+         << "                            $HOME/.vectorfitting/tuning)."
+         << endl
+         << "  -t, --max-threads N       Highest thread count tried, 0 for"
+         << " all (0)." << endl
+         << "  -h, --help                Shows this message." << endl;
+}
+
+size_t toSize(const string& value) {
+    char* end;
+    const long res = strtol(value.c_str(), &end, 10);
+    if (*end != '\0' || res < 0) {
+        throw runtime_error("Invalid number: " + value);
+    }
+    return (size_t) res;
+}
+
+Arguments parse(int argc, char** argv) {
+    Arguments args;
+    for (int i = 1; i < argc; ++i) {
+        const string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            exit(EXIT_SUCCESS);
+        }
+        if (i + 1 >= argc) {
+            throw runtime_error("Missing value for " + arg);
+        }
+        const string value = argv[++i];
+        if (arg == "-o" || arg == "--output") {
+            args.output = value;
+        } else if (arg == "-t" || arg == "--max-threads") {
+            args.maxThreads = toSize(value);
+        } else {
+            throw runtime_error("Unknown option: " + arg);
+        }
+    }
+    if (args.output.empty()) {
+        args.output = Tuning::getDefaultPath();
+        if (args.output.empty()) {
+            throw runtime_error("No output and no default profile path");
+        }
+    }
+    return args;
+}
+
+vector<Sample> buildSamples(const size_t Ns, const size_t N,
+                            const size_t Nc, const size_t seed = 0) {
+    Generator generator(seed);
+    generator.setSamplesSize(Ns);
+    generator.setOrder(N);
+    generator.setResponseSize(Nc);
+    return generator.getSamples();
+}
+
+// Best of three, after a warm up run.
+template<typename F>
+double getSeconds(F run) {
+    run();
+    double res = 0.0;
+    for (size_t r = 0; r < 3; ++r) {
+        const chrono::steady_clock::time_point start =
+                chrono::steady_clock::now();
+        run();
+        const double seconds = chrono::duration<double>(
+                chrono::steady_clock::now() - start).count();
+        res = (r == 0) ? seconds : min(res, seconds);
+    }
+    return res;
+}
+
+vector<size_t> getThreadCounts(const size_t maxThreads) {
+    vector<size_t> res;
+    for (size_t t = 1; t < maxThreads; t *= 2) {
+        res.push_back(t);
+    }
+    res.push_back(maxThreads);
+    return res;
+}
+
+// Fewest threads within the tolerance of the fastest time.
+size_t pickThreads(const vector<size_t>& threads,
+                   const vector<double>& seconds,
+                   const double tolerance) {
+    const double best = *min_element(seconds.begin(), seconds.end());
+    for (size_t i = 0; i < threads.size(); ++i) {
+        if (seconds[i] <= best * (1.0 + tolerance)) {
+            return threads[i];
+        }
+    }
+    return threads.back();
+}
+
+void makeParentDirectory(const string& filename) {
+    const size_t slash = filename.find_last_of('/');
+    if (slash != string::npos && slash != 0) {
+        mkdir(filename.substr(0, slash).c_str(), 0755);
+    }
+}
+
+} /* namespace */
+
+int main(int argc, char** argv) {
+    Arguments args;
+    try {
+        args = parse(argc, argv);
+    } catch (const exception& e) {
+        cerr << "vfittune: " << e.what() << endl;
+        printUsage();
+        return EXIT_FAILURE;
+    }
+#ifdef _OPENMP
+    const size_t available = (size_t) omp_get_max_threads();
+#else
+    const size_t available = 1;
+#endif
+    const size_t maxThreads = args.maxThreads == 0 ? available
+                                                   : args.maxThreads;
+    const vector<size_t> threadCounts = getThreadCounts(maxThreads);
+
+    // Measurements start from the built-in defaults, not from a previous
+    // profile.
+    Tuning tuning;
+    Tuning::set(tuning);
+
+    try {
+        cout << "Per response loop of fit()" << endl;
+        const size_t N = 20;
+        const vector<Sample> samples = buildSamples(2000, N, 4 * maxThreads);
+        const vector<Complex> poles =
+                VectorFitting::VectorFitting::getStartingPoles(samples, N);
+        vector<double> seconds;
+        for (size_t i = 0; i < threadCounts.size(); ++i) {
+            tuning.fitThreads = threadCounts[i];
+            Tuning::set(tuning);
+            seconds.push_back(getSeconds([&]() {
+                VectorFitting::VectorFitting fitting(samples, poles,
+                                                     Options());
+                fitting.fit();
+            }));
+            cout << "  " << threadCounts[i] << " threads: "
+                 << seconds.back() * 1e3 << " ms" << endl;
+        }
+        tuning.fitThreads = pickThreads(threadCounts, seconds,
+                                        args.tolerance);
+        Tuning::set(tuning);
+
+        cout << "Solver of the per response systems" << endl;
+        Options qr, normal;
+        normal.setSolver(Options::normalEquations);
+        const double qrSeconds = getSeconds([&]() {
+            VectorFitting::VectorFitting(samples, poles, qr).fit();
+        });
+        const double normalSeconds = getSeconds([&]() {
+            VectorFitting::VectorFitting(samples, poles, normal).fit();
+        });
+        cout << "  Householder QR: " << qrSeconds * 1e3 << " ms" << endl
+             << "  Normal equations: " << normalSeconds * 1e3 << " ms"
+             << endl;
+        if (normalSeconds > qrSeconds * (1.0 - args.tolerance)) {
+            // Not worth their loss of accuracy here.
+            tuning.normalEquationsCondition = 0.0;
+        }
+
+        cout << "Batches of independent fits" << endl;
+        vector<vector<Sample>> jobs(4 * maxThreads);
+        for (size_t j = 0; j < jobs.size(); ++j) {
+            jobs[j] = buildSamples(500, 10, 2, j + 1);
+        }
+        seconds.clear();
+        for (size_t i = 0; i < threadCounts.size(); ++i) {
+            BatchFitter fitter;
+            fitter.setOrders(10, 10);
+            fitter.setIterations(3);
+            fitter.setThreads(threadCounts[i]);
+            seconds.push_back(getSeconds([&]() {
+                fitter.fit(jobs);
+            }));
+            cout << "  " << threadCounts[i] << " threads: "
+                 << seconds.back() * 1e3 << " ms" << endl;
+        }
+        tuning.batchThreads = pickThreads(threadCounts, seconds,
+                                          args.tolerance);
+
+        cout << "Cost model" << endl;
+        CostModel model;
+        model.calibrate();
+        tuning.flopRate = model.getFlopRate();
+        tuning.parallelEfficiency = model.getParallelEfficiency();
+        tuning.overhead = model.getOverhead();
+
+        makeParentDirectory(args.output);
+        tuning.write(args.output);
+    } catch (const exception& e) {
+        cerr << "vfittune: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    cout << endl << "Profile written to " << args.output << ":" << endl
+         << "  fitThreads = " << tuning.fitThreads << endl
+         << "  batchThreads = " << tuning.batchThreads << endl
+         << "  normalEquationsCondition = "
+         << tuning.normalEquationsCondition << endl
+         << "  flopRate = " << tuning.flopRate << endl
+         << "  parallelEfficiency = " << tuning.parallelEfficiency << endl
+         << "  overhead = " << tuning.overhead << endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,219 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Allocation.h"
+
+#include <atomic>
+
+#ifdef CompileWithAllocationTracking
+#include <cerrno>
+#include <malloc.h>
+
+// glibc entry points, the ones below replace the public names.
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t n, std::size_t size);
+void* __libc_realloc(void* ptr, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void  __libc_free(void* ptr);
+}
+#endif
+
+namespace VectorFitting {
+
+const std::size_t Allocation::Peak::maxPeaks;
+
+namespace {
+
+std::atomic<std::size_t> count(0);
+std::atomic<std::size_t> bytes(0);
+std::atomic<std::size_t> current(0);
+std::atomic<std::size_t> peak(0);
+std::atomic<std::size_t> guards(0);
+std::atomic<std::size_t> violations(0);
+
+// Marks of the live Peak objects, one bit of slots per object.
+std::atomic<unsigned long long> slots(0);
+std::atomic<std::size_t> marks[Allocation::Peak::maxPeaks];
+
+#ifdef CompileWithAllocationTracking
+void raise(std::atomic<std::size_t>& mark, const std::size_t now) {
+    std::size_t highest = mark.load(std::memory_order_relaxed);
+    while (now > highest && !mark.compare_exchange_weak(highest, now,
+            std::memory_order_relaxed)) {
+    }
+}
+
+// Requested sizes are accumulated, usage follows the actual block sizes as
+// those are the only ones known when freeing.
+void onAllocate(void* ptr, const std::size_t requested) {
+    if (ptr == NULL) {
+        return;
+    }
+    const std::size_t size = malloc_usable_size(ptr);
+    count.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(requested, std::memory_order_relaxed);
+    const std::size_t now =
+            current.fetch_add(size, std::memory_order_relaxed) + size;
+    raise(peak, now);
+    for (unsigned long long live = slots.load(std::memory_order_relaxed);
+            live != 0; live &= live - 1) {
+        raise(marks[__builtin_ctzll(live)], now);
+    }
+    if (guards.load(std::memory_order_relaxed) > 0) {
+        violations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void onFree(const std::size_t size) {
+    current.fetch_sub(size, std::memory_order_relaxed);
+}
+#endif
+
+} /* namespace */
+
+bool Allocation::isTracking() {
+#ifdef CompileWithAllocationTracking
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::size_t Allocation::getCount() {
+    return count.load(std::memory_order_relaxed);
+}
+
+std::size_t Allocation::getBytes() {
+    return bytes.load(std::memory_order_relaxed);
+}
+
+std::size_t Allocation::getCurrent() {
+    return current.load(std::memory_order_relaxed);
+}
+
+std::size_t Allocation::getPeak() {
+    return peak.load(std::memory_order_relaxed);
+}
+
+Allocation::Peak::Peak() : slot_(-1) {
+#ifdef CompileWithAllocationTracking
+    unsigned long long live = slots.load(std::memory_order_relaxed);
+    while (~live != 0) {
+        const int slot = __builtin_ctzll(~live);
+        if (slots.compare_exchange_weak(live, live | (1ULL << slot),
+                                        std::memory_order_acq_rel)) {
+            slot_ = slot;
+            reset();
+            break;
+        }
+    }
+#endif
+}
+
+Allocation::Peak::~Peak() {
+    if (slot_ >= 0) {
+        slots.fetch_and(~(1ULL << slot_), std::memory_order_acq_rel);
+    }
+}
+
+void Allocation::Peak::reset() {
+    if (slot_ >= 0) {
+        marks[slot_].store(current.load(std::memory_order_relaxed),
+                           std::memory_order_relaxed);
+    }
+}
+
+std::size_t Allocation::Peak::get() const {
+    if (slot_ < 0) {
+        return 0;
+    }
+    return marks[slot_].load(std::memory_order_relaxed);
+}
+
+Allocation::Guard::Guard() {
+    start_ = violations.load(std::memory_order_relaxed);
+    guards.fetch_add(1, std::memory_order_relaxed);
+}
+
+Allocation::Guard::~Guard() {
+    guards.fetch_sub(1, std::memory_order_relaxed);
+}
+
+std::size_t Allocation::Guard::getViolations() const {
+    return violations.load(std::memory_order_relaxed) - start_;
+}
+
+} /* namespace VectorFitting */
+
+#ifdef CompileWithAllocationTracking
+extern "C" {
+
+void* malloc(std::size_t size) {
+    void* res = __libc_malloc(size);
+    VectorFitting::onAllocate(res, size);
+    return res;
+}
+
+void* calloc(std::size_t n, std::size_t size) {
+    void* res = __libc_calloc(n, size);
+    VectorFitting::onAllocate(res, n * size);
+    return res;
+}
+
+void* realloc(void* ptr, std::size_t size) {
+    const std::size_t old = ptr == NULL ? 0 : malloc_usable_size(ptr);
+    void* res = __libc_realloc(ptr, size);
+    if (res != NULL || size == 0) {
+        VectorFitting::onFree(old);
+        VectorFitting::onAllocate(res, size);
+    }
+    return res;
+}
+
+void* memalign(std::size_t alignment, std::size_t size) {
+    void* res = __libc_memalign(alignment, size);
+    VectorFitting::onAllocate(res, size);
+    return res;
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) {
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, std::size_t alignment, std::size_t size) {
+    void* res = memalign(alignment, size);
+    if (res == NULL) {
+        return ENOMEM;
+    }
+    *ptr = res;
+    return 0;
+}
+
+void free(void* ptr) {
+    if (ptr != NULL) {
+        VectorFitting::onFree(malloc_usable_size(ptr));
+    }
+    __libc_free(ptr);
+}
+
+} /* extern "C" */
+#endif
@@ -0,0 +1,87 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEMBA_VECTOR_FITTING_ALLOCATION_H_
+#define SEMBA_VECTOR_FITTING_ALLOCATION_H_
+
+#include <cstddef>
+
+namespace VectorFitting {
+
+/**
+ * Process-wide accounting of heap allocations. When built with
+ * CompileWithAllocationTracking, malloc and friends are interposed and every
+ * allocation of any thread, Eigen temporaries included, is counted;
+ * otherwise all counters stay at zero. Counts are only attributable to a
+ * fit when no other fit runs at the same time.
+ */
+class Allocation {
+public:
+    static bool isTracking();
+
+    static std::size_t getCount();      // Allocations made.
+    static std::size_t getBytes();      // Bytes requested, freed or not.
+    static std::size_t getCurrent();    // Bytes in use.
+    static std::size_t getPeak();       // Highest getCurrent() so far.
+
+    /**
+     * High-water mark of getCurrent() while an object is alive. Each object
+     * keeps its own, so concurrent fits do not reset each other's, though
+     * the heap they watch is still shared. Up to maxPeaks objects are
+     * tracked at once, further ones read zero.
+     */
+    class Peak {
+    public:
+        static const std::size_t maxPeaks = 64;
+
+        Peak();
+        ~Peak();
+
+        // Restarts the mark at the current usage.
+        void reset();
+        std::size_t get() const;
+
+    private:
+        Peak(const Peak&);
+        Peak& operator=(const Peak&);
+
+        int slot_;
+    };
+
+    /**
+     * Counts allocations made by any thread while an object is alive, for
+     * tests asserting that a code path does not allocate.
+     */
+    class Guard {
+    public:
+        Guard();
+        ~Guard();
+
+        std::size_t getViolations() const;
+
+    private:
+        std::size_t start_;
+    };
+};
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_ALLOCATION_H_ */
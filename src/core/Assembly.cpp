@@ -0,0 +1,111 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Assembly.h"
+
+#include <algorithm>
+
+namespace VectorFitting {
+
+const std::size_t Assembly::tileSize;
+
+void Assembly::buildPoleSystem(const MatrixXcd& Dk,
+                               const std::size_t left,
+                               const std::size_t right,
+                               const MatrixXd& weights,
+                               const MatrixXcd& responses,
+                               const std::size_t n,
+                               MatrixXd& A,
+                               const std::size_t frozen) {
+    const std::size_t Ns = Dk.rows();
+    A.resize(2*Ns + 1, left + right);
+    A.row(2*Ns).setZero();
+    const Real* w = weights.col(n).data();
+    const Complex* f = responses.col(n).data();
+    const std::size_t cols = std::max(left, right);
+    for (std::size_t i0 = 0; i0 < Ns; i0 += tileSize) {
+        const std::size_t i1 = std::min(i0 + tileSize, Ns);
+        for (std::size_t m = 0; m < cols; ++m) {
+            const Complex* d = Dk.col(m).data();
+            Real* l = m < left  ? A.col(m).data()        : NULL;
+            Real* r = m < right ? A.col(left + m).data() : NULL;
+            // The right block reads its last column past the frozen ones.
+            const Complex* dr = (frozen != 0 && m+1 == right) ?
+                    Dk.col(m + frozen).data() : d;
+            for (std::size_t i = i0; i < i1; ++i) {
+                const Complex entry = w[i] * d[i];
+                if (l != NULL) {
+                    l[i   ] = std::real(entry);
+                    l[i+Ns] = std::imag(entry);
+                }
+                if (r != NULL) {
+                    const Complex data = - (dr == d ? entry : w[i] * dr[i])
+                                       * f[i];
+                    r[i   ] = std::real(data);
+                    r[i+Ns] = std::imag(data);
+                }
+            }
+        }
+    }
+}
+
+void Assembly::buildResidueSystem(const MatrixXcd& basis,
+                                  const std::size_t cols,
+                                  const MatrixXd& weights,
+                                  const MatrixXcd& responses,
+                                  const MatrixXd& norms,
+                                  const std::size_t n,
+                                  MatrixXd& A,
+                                  VectorXd& b) {
+    const std::size_t Ns = basis.rows();
+    A.resize(2*Ns, cols);
+    b.resize(2*Ns);
+    const Real* w = weights.col(n).data();
+    const Complex* f = responses.col(n).data();
+    const VectorXd inverse = norms.col(n).cwiseInverse();
+    for (std::size_t i0 = 0; i0 < Ns; i0 += tileSize) {
+        const std::size_t i1 = std::min(i0 + tileSize, Ns);
+        for (std::size_t i = i0; i < i1; ++i) {
+            b(i   ) = std::real(f[i]) * w[i];
+            b(i+Ns) = std::imag(f[i]) * w[i];
+        }
+        for (std::size_t m = 0; m < cols; ++m) {
+            const Complex* d = basis.col(m).data();
+            Real* a = A.col(m).data();
+            const Real scale = inverse(m);
+            for (std::size_t i = i0; i < i1; ++i) {
+                const Real weight = w[i] * scale;
+                a[i   ] = std::real(d[i]) * weight;
+                a[i+Ns] = std::imag(d[i]) * weight;
+            }
+        }
+    }
+}
+
+MatrixXd Assembly::getColumnNorms(const MatrixXcd& basis,
+                                  const std::size_t cols,
+                                  const MatrixXd& weights) {
+    return (basis.leftCols(cols).cwiseAbs2().transpose()
+            * weights.cwiseAbs2()).cwiseSqrt();
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,88 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SEMBA_VECTOR_FITTING_ASSEMBLY_H_
+#define SEMBA_VECTOR_FITTING_ASSEMBLY_H_
+
+#include "VectorFitting.h"
+
+namespace VectorFitting {
+
+/**
+ * Builds the real least squares systems of fit() in one sweep over tiles of
+ * tileSize frequencies: the basis, weights and data of a tile are read once,
+ * while in cache, for every column of the system. Real parts go to the
+ * first Ns rows and imaginary parts to the next Ns, as they always have, so
+ * that the factorizations round as before.
+ */
+class Assembly {
+public:
+    static const std::size_t tileSize = 64;
+
+    /**
+     * System of pole identification for response n: left block w*Dk for
+     * the first left columns of Dk, right block -w*Dk*f for the first right
+     * ones. Its last row, for the integral criterion, is zero.
+     * @param Dk        Basis. Size: Ns, at least max(left, right+frozen).
+     * @param weights   Size: Ns, Nc.
+     * @param responses Size: Ns, Nc.
+     * @param A         Resized to 2Ns+1, left+right.
+     * @param frozen    Columns of frozen poles, skipped by the right block
+     *                  before its last column.
+     */
+    static void buildPoleSystem(const MatrixXcd& Dk,
+                                const std::size_t left,
+                                const std::size_t right,
+                                const MatrixXd& weights,
+                                const MatrixXcd& responses,
+                                const std::size_t n,
+                                MatrixXd& A,
+                                const std::size_t frozen = 0);
+
+    /**
+     * Column scaled system of residue identification for response n:
+     * w*basis(:,j)/norms(j,n) for the first cols columns of the basis and
+     * right hand side w*f.
+     * @param norms     See getColumnNorms().
+     * @param A         Resized to 2Ns, cols.
+     * @param b         Resized to 2Ns.
+     */
+    static void buildResidueSystem(const MatrixXcd& basis,
+                                   const std::size_t cols,
+                                   const MatrixXd& weights,
+                                   const MatrixXcd& responses,
+                                   const MatrixXd& norms,
+                                   const std::size_t n,
+                                   MatrixXd& A,
+                                   VectorXd& b);
+
+    // Column norms of the first cols columns of the weighted basis of every
+    // response, as a single product instead of a pass over each system.
+    // Size: cols, Nc.
+    static MatrixXd getColumnNorms(const MatrixXcd& basis,
+                                   const std::size_t cols,
+                                   const MatrixXd& weights);
+};
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_ASSEMBLY_H_ */
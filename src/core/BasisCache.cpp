@@ -0,0 +1,135 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "BasisCache.h"
+#include "Hash.h"
+#include "SampleSet.h"
+
+#include <stdexcept>
+
+namespace VectorFitting {
+
+bool BasisCache::Key::operator<(const Key& rhs) const {
+    if (grid   != rhs.grid  ) return grid   < rhs.grid;
+    if (poles  != rhs.poles ) return poles  < rhs.poles;
+    if (Ns     != rhs.Ns    ) return Ns     < rhs.Ns;
+    if (N      != rhs.N     ) return N      < rhs.N;
+    return linear < rhs.linear;
+}
+
+BasisCache::BasisCache(const std::size_t capacityBytes) {
+    if (capacityBytes == 0) {
+        throw std::runtime_error("Basis cache capacity cannot be zero");
+    }
+    capacity_ = capacityBytes;
+    clock_ = 0;
+    bytes_ = 0;
+}
+
+BasisCache::~BasisCache() {
+}
+
+std::shared_ptr<const MatrixXcd> BasisCache::get(
+        const SampleSet& data,
+        const VectorXcd& poles,
+        const Options::AsymptoticTrend trend) const {
+    const Key key = buildKey(data, poles, trend);
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<Key, Entry>::iterator it = entries_.find(key);
+    // Grid and poles are compared in full, their hashes only find the
+    // entry.
+    if (it == entries_.end() || it->second.poles != poles
+            || it->second.grid != data.getFrequencies()) {
+        return std::shared_ptr<const MatrixXcd>();
+    }
+    it->second.lastUse = ++clock_;
+    return it->second.basis;
+}
+
+void BasisCache::set(const SampleSet& data,
+                     const VectorXcd& poles,
+                     const Options::AsymptoticTrend trend,
+                     const std::shared_ptr<const MatrixXcd>& basis) {
+    const std::size_t bytes = getBytes(*basis);
+    if (bytes > capacity_) {
+        return;
+    }
+    const Key key = buildKey(data, poles, trend);
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<Key, Entry>::iterator found = entries_.find(key);
+    if (found != entries_.end()) {
+        bytes_ -= getBytes(*found->second.basis);
+        entries_.erase(found);
+    }
+    while (bytes_ + bytes > capacity_) {
+        std::map<Key, Entry>::iterator oldest = entries_.begin();
+        for (std::map<Key, Entry>::iterator it = entries_.begin();
+                it != entries_.end(); ++it) {
+            if (it->second.lastUse < oldest->second.lastUse) {
+                oldest = it;
+            }
+        }
+        bytes_ -= getBytes(*oldest->second.basis);
+        entries_.erase(oldest);
+    }
+    Entry& entry = entries_[key];
+    entry.grid = data.getFrequencies();
+    entry.poles = poles;
+    entry.basis = basis;
+    entry.lastUse = ++clock_;
+    bytes_ += bytes;
+}
+
+std::size_t BasisCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+std::size_t BasisCache::getBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+void BasisCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    bytes_ = 0;
+}
+
+BasisCache::Key BasisCache::buildKey(const SampleSet& data,
+                                     const VectorXcd& poles,
+                                     const Options::AsymptoticTrend trend) {
+    Key key;
+    key.grid   = data.getGridHash();
+    key.poles  = hashValues(poles.data(), poles.size());
+    key.Ns     = data.getSamplesSize();
+    key.N      = poles.size();
+    // Only the last column of the basis depends on the trend.
+    key.linear = trend == Options::linear;
+    return key;
+}
+
+std::size_t BasisCache::getBytes(const MatrixXcd& basis) {
+    return basis.size() * sizeof(Complex);
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,89 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SEMBA_VECTOR_FITTING_BASISCACHE_H_
+#define SEMBA_VECTOR_FITTING_BASISCACHE_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "VectorFitting.h"
+
+namespace VectorFitting {
+
+/**
+ * Thread-safe store of basis matrices Dk, shared by the fits of data sampled
+ * on the same grid that start from the same poles, such as batch jobs using
+ * the default starting poles. Entries are handed out read-only and stay
+ * valid while used, even after being dropped. When over capacity, the least
+ * recently used entries are dropped.
+ */
+class BasisCache {
+public:
+    explicit BasisCache(const std::size_t capacityBytes = 256 << 20);
+    virtual ~BasisCache();
+
+    // Null when not stored.
+    std::shared_ptr<const MatrixXcd> get(
+            const SampleSet& data,
+            const VectorXcd& poles,
+            const Options::AsymptoticTrend trend) const;
+    // Not stored when larger than the capacity.
+    void set(const SampleSet& data,
+             const VectorXcd& poles,
+             const Options::AsymptoticTrend trend,
+             const std::shared_ptr<const MatrixXcd>& basis);
+
+    std::size_t size() const;
+    std::size_t getBytes() const;
+    void clear();
+
+private:
+    struct Key {
+        uint64_t grid, poles;
+        std::size_t Ns, N;
+        bool linear;
+
+        bool operator<(const Key& rhs) const;
+    };
+    struct Entry {
+        VectorXcd grid, poles;
+        std::shared_ptr<const MatrixXcd> basis;
+        uint64_t lastUse;
+    };
+
+    std::size_t capacity_;
+    mutable std::mutex mutex_;
+    mutable uint64_t clock_;
+    std::size_t bytes_;
+    mutable std::map<Key, Entry> entries_;
+
+    static Key buildKey(const SampleSet& data,
+                        const VectorXcd& poles,
+                        const Options::AsymptoticTrend trend);
+    static std::size_t getBytes(const MatrixXcd& basis);
+};
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_BASISCACHE_H_ */
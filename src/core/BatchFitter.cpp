@@ -0,0 +1,293 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "BatchFitter.h"
+#include "SampleSet.h"
+#include "Trace.h"
+#include "Tuning.h"
+
+#include <exception>
+#include <limits>
+#include <stdexcept>
+
+namespace VectorFitting {
+
+BatchFitter::BatchFitter(const Options& options) {
+    options_    = options;
+    minOrder_   = 10;
+    maxOrder_   = 10;
+    orderStep_  = 2;
+    targetRMSE_ = 0.0;
+    iterations_ = 5;
+    weighting_  = uniform;
+    threads_    = 0;
+    refinement_ = false;
+    poleCache_  = NULL;
+    basisCache_ = NULL;
+    reducer_    = NULL;
+}
+
+BatchFitter::~BatchFitter() {
+}
+
+const Options& BatchFitter::getOptions() const {
+    return options_;
+}
+
+std::size_t BatchFitter::getMinOrder() const {
+    return minOrder_;
+}
+
+std::size_t BatchFitter::getMaxOrder() const {
+    return maxOrder_;
+}
+
+std::size_t BatchFitter::getOrderStep() const {
+    return orderStep_;
+}
+
+Real BatchFitter::getTargetRMSE() const {
+    return targetRMSE_;
+}
+
+std::size_t BatchFitter::getIterations() const {
+    return iterations_;
+}
+
+BatchFitter::Weighting BatchFitter::getWeighting() const {
+    return weighting_;
+}
+
+std::size_t BatchFitter::getThreads() const {
+    return threads_;
+}
+
+bool BatchFitter::isRefinement() const {
+    return refinement_;
+}
+
+PoleCache* BatchFitter::getPoleCache() const {
+    return poleCache_;
+}
+
+BasisCache* BatchFitter::getBasisCache() const {
+    return basisCache_;
+}
+
+Reducer* BatchFitter::getReducer() const {
+    return reducer_;
+}
+
+void BatchFitter::setOptions(const Options& options) {
+    options_ = options;
+}
+
+void BatchFitter::setOrders(const std::size_t minOrder,
+                            const std::size_t maxOrder,
+                            const std::size_t step) {
+    if (minOrder == 0 || maxOrder < minOrder) {
+        throw std::runtime_error("Invalid range of orders");
+    }
+    if (minOrder % 2 != 0 || step % 2 != 0 || step == 0) {
+        throw std::runtime_error(
+                "Default starting poles are complex, orders must be even");
+    }
+    minOrder_  = minOrder;
+    maxOrder_  = maxOrder;
+    orderStep_ = step;
+}
+
+void BatchFitter::setTargetRMSE(const Real targetRMSE) {
+    targetRMSE_ = targetRMSE;
+}
+
+void BatchFitter::setIterations(const std::size_t iterations) {
+    if (iterations == 0) {
+        throw std::runtime_error("At least one iteration is needed");
+    }
+    iterations_ = iterations;
+}
+
+void BatchFitter::setWeighting(const Weighting weighting) {
+    weighting_ = weighting;
+}
+
+void BatchFitter::setThreads(const std::size_t threads) {
+    threads_ = threads;
+}
+
+void BatchFitter::setRefinement(const bool refinement) {
+    refinement_ = refinement;
+}
+
+void BatchFitter::setPoleCache(PoleCache* poleCache) {
+    poleCache_ = poleCache;
+}
+
+void BatchFitter::setBasisCache(BasisCache* basisCache) {
+    basisCache_ = basisCache;
+}
+
+void BatchFitter::setReducer(Reducer* reducer) {
+    reducer_ = reducer;
+}
+
+void BatchFitter::setSolverPolicy(const SolverPolicy& policy) {
+    solverPolicy_ = policy;
+}
+
+Result BatchFitter::fit(const std::vector<Sample>& samples,
+                        const std::size_t id) const {
+    Trace::Scope trace("job", "batch", id);
+    // Shared by the fits of every order.
+    const std::shared_ptr<const SampleSet> data =
+            SampleSet::build(samples, getWeights(samples, weighting_));
+
+    Result best;
+    best.rmse = std::numeric_limits<Real>::max();
+    Statistics statistics;
+    // Poles and error of the last order, refined into the next one.
+    std::vector<Complex> refined;
+    std::vector<Real> errors;
+    for (std::size_t order = minOrder_; order <= maxOrder_;
+            order += orderStep_) {
+        Trace::Scope traceOrder("order", "batch", order);
+        const Options::AsymptoticTrend trend = options_.getAsymptoticTrend();
+        std::vector<Complex> poles;
+        if (!errors.empty()) {
+            poles = VectorFitting::getRefinedPoles(*data, refined, errors,
+                                                   orderStep_ / 2);
+        }
+        if (poles.size() != order &&
+                (poleCache_ == NULL
+                 || !poleCache_->get(*data, order, trend, poles))) {
+            poles = VectorFitting::getStartingPoles(*data, order);
+        }
+        VectorFitting fitting(data, poles, options_);
+        fitting.setReducer(reducer_);
+        fitting.setBasisCache(basisCache_);
+        fitting.setSolverPolicy(solverPolicy_);
+        Result current;
+        current.rmse = std::numeric_limits<Real>::max();
+        std::vector<Real> currentErrors, candidateErrors;
+        for (std::size_t iter = 0; iter < iterations_; ++iter) {
+            fitting.fit();
+            // One evaluation of the model gives every metric.
+            Result candidate = fitting.getResult(
+                    id, refinement_ ? &candidateErrors : NULL);
+            statistics += candidate.statistics;
+            if (candidate.rmse < current.rmse) {
+                current = std::move(candidate);
+                currentErrors.swap(candidateErrors);
+            }
+            if (refinement_ && current.rmse <= targetRMSE_) {
+                break;
+            }
+        }
+        if (refinement_) {
+            refined.assign(current.poles.data(),
+                           current.poles.data() + current.poles.size());
+            errors.swap(currentErrors);
+        }
+        if (poleCache_ != NULL) {
+            poleCache_->set(*data, order, trend, std::vector<Complex>(
+                    current.poles.data(),
+                    current.poles.data() + current.poles.size()));
+        }
+        if (current.rmse < best.rmse) {
+            best = std::move(current);
+        }
+        if (best.rmse <= targetRMSE_) {
+            break;
+        }
+    }
+    best.statistics = statistics;
+    return best;
+}
+
+std::vector<Result> BatchFitter::fit(
+        const std::vector<std::vector<Sample>>& jobs) const {
+    std::vector<Result> res(jobs.size());
+    std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic) num_threads(getNumThreads())
+    for (long i = 0; i < (long) jobs.size(); ++i) {
+        try {
+            res[i] = fit(jobs[i], (std::size_t) i);
+        } catch (...) {
+#pragma omp critical
+            error = std::current_exception();
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return res;
+}
+
+void BatchFitter::fit(const std::vector<std::vector<Sample>>& jobs,
+                      ResultChannel& channel) const {
+    std::exception_ptr error;
+#pragma omp parallel for schedule(dynamic) num_threads(getNumThreads())
+    for (long i = 0; i < (long) jobs.size(); ++i) {
+        try {
+            channel.push(fit(jobs[i], (std::size_t) i));
+        } catch (...) {
+#pragma omp critical
+            error = std::current_exception();
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+std::vector<std::vector<Real>> BatchFitter::getWeights(
+        const std::vector<Sample>& samples,
+        const Weighting weighting) {
+    std::vector<std::vector<Real>> res;
+    if (weighting == uniform) {
+        return res;
+    }
+    res.resize(samples.size());
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        res[i].resize(samples[i].second.size());
+        for (std::size_t j = 0; j < samples[i].second.size(); ++j) {
+            const Real mag = std::abs(samples[i].second[j]);
+            if (equal(mag, 0.0)) {
+                res[i][j] = 1.0;
+            } else if (weighting == inverseSqrtMagnitude) {
+                res[i][j] = 1.0 / std::sqrt(mag);
+            } else {
+                res[i][j] = 1.0 / mag;
+            }
+        }
+    }
+    return res;
+}
+
+int BatchFitter::getNumThreads() const {
+    if (threads_ != 0) {
+        return (int) threads_;
+    }
+    return Tuning::getThreads(Tuning::get().batchThreads);
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,130 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEMBA_VECTOR_FITTING_BATCHFITTER_H_
+#define SEMBA_VECTOR_FITTING_BATCHFITTER_H_
+
+#include <vector>
+
+#include "VectorFitting.h"
+#include "BasisCache.h"
+#include "PoleCache.h"
+#include "Reducer.h"
+
+namespace VectorFitting {
+
+/**
+ * Fits many independent data sets, searching for each one the lowest order
+ * within a range that reaches a target RMSE. Jobs run in parallel.
+ */
+class BatchFitter {
+public:
+    enum Weighting {
+        uniform,
+        inverseSqrtMagnitude,
+        inverseMagnitude
+    };
+
+    BatchFitter(const Options& options = Options());
+    virtual ~BatchFitter();
+
+    const Options& getOptions() const;
+    std::size_t getMinOrder() const;
+    std::size_t getMaxOrder() const;
+    std::size_t getOrderStep() const;
+    Real getTargetRMSE() const;
+    std::size_t getIterations() const;
+    Weighting getWeighting() const;
+    std::size_t getThreads() const;
+    bool isRefinement() const;
+    PoleCache* getPoleCache() const;
+    BasisCache* getBasisCache() const;
+    Reducer* getReducer() const;
+
+    void setOptions(const Options& options);
+    void setOrders(const std::size_t minOrder,
+                   const std::size_t maxOrder,
+                   const std::size_t step = 2);
+    void setTargetRMSE(const Real targetRMSE);
+    void setIterations(const std::size_t iterations);
+    void setWeighting(const Weighting weighting);
+    // Zero takes the tuning profile, or lets OpenMP decide.
+    void setThreads(const std::size_t threads);
+    /**
+     * When set, each order after the lowest one starts from the poles of
+     * the previous order, with step/2 pairs added where its error peaks,
+     * instead of from the default starting poles. See
+     * VectorFitting::getRefinedPoles(). Relocation of an order also stops
+     * as soon as it reaches the target RMSE.
+     */
+    void setRefinement(const bool refinement);
+    // Not owned. When set, fits start from cached poles and store theirs.
+    void setPoleCache(PoleCache* poleCache);
+    // Not owned. When set, jobs on the same grid share their first basis.
+    void setBasisCache(BasisCache* basisCache);
+    /**
+     * Not owned. When set, every single data set fit is shared with the
+     * other participants of the reducer, which must make the same calls.
+     * Order search decisions are taken on gathered, identical, metrics.
+     */
+    void setReducer(Reducer* reducer);
+    // See VectorFitting::setSolverPolicy().
+    void setSolverPolicy(const SolverPolicy& policy);
+
+    /**
+     * Fits a single data set. Orders are tried from the lowest one and the
+     * search stops as soon as the target RMSE is reached; otherwise the best
+     * model found is returned.
+     */
+    Result fit(const std::vector<Sample>& samples,
+               const std::size_t id = 0) const;
+
+    // Results are returned in the same order as the jobs.
+    std::vector<Result> fit(
+            const std::vector<std::vector<Sample>>& jobs) const;
+
+    // Each result is pushed into the channel as soon as it is ready.
+    void fit(const std::vector<std::vector<Sample>>& jobs,
+             ResultChannel& channel) const;
+
+    static std::vector<std::vector<Real>> getWeights(
+            const std::vector<Sample>& samples,
+            const Weighting weighting);
+
+private:
+    Options options_;
+    std::size_t minOrder_, maxOrder_, orderStep_;
+    Real targetRMSE_;
+    std::size_t iterations_;
+    Weighting weighting_;
+    std::size_t threads_;
+    bool refinement_;
+    PoleCache* poleCache_;
+    BasisCache* basisCache_;
+    Reducer* reducer_;
+    SolverPolicy solverPolicy_;
+
+    int getNumThreads() const;
+};
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_BATCHFITTER_H_ */
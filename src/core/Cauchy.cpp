@@ -0,0 +1,204 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Cauchy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace VectorFitting {
+
+const std::size_t Cauchy::denseOrder;
+const std::size_t Cauchy::leafSize;
+
+namespace {
+
+// Groups within this fraction of their distance to a frequency are
+// expanded, each term gains a factor of it.
+const Real separation = 0.5;
+
+} /* namespace */
+
+Cauchy::Cauchy(const VectorXcd& frequencies,
+               const VectorXcd& poles,
+               const Real tolerance)
+:   frequencies_(frequencies),
+    poles_(poles),
+    dense_(true),
+    terms_(0) {
+    if (tolerance < 0.0 || tolerance >= 1.0) {
+        throw std::runtime_error("Tolerance must be in [0, 1)");
+    }
+    const std::size_t Ns = frequencies.size();
+    const std::size_t N  = poles.size();
+    dense_ = tolerance == 0.0 || N < denseOrder;
+    if (dense_) {
+        return;
+    }
+    terms_ = std::max<std::size_t>(1,
+            (std::size_t) std::ceil(std::log(tolerance)
+                                    / std::log(separation)));
+
+    order_.resize(N);
+    for (std::size_t m = 0; m < N; ++m) {
+        order_[m] = m;
+    }
+    std::sort(order_.begin(), order_.end(),
+              [&](std::size_t a, std::size_t b) {
+        if (std::imag(poles(a)) != std::imag(poles(b))) {
+            return std::imag(poles(a)) < std::imag(poles(b));
+        }
+        return std::real(poles(a)) < std::real(poles(b));
+    });
+    sorted_.resize(N);
+    for (std::size_t m = 0; m < N; ++m) {
+        sorted_(m) = poles(order_[m]);
+    }
+    nodes_.reserve(2 * N / leafSize + 1);
+    build(0, N);
+
+    // Interactions, from the root down.
+    farBegin_.assign(1, 0);
+    nearBegin_.assign(1, 0);
+    std::vector<std::size_t> stack;
+    for (std::size_t i = 0; i < Ns; ++i) {
+        stack.assign(1, 0);
+        while (!stack.empty()) {
+            const Node& node = nodes_[stack.back()];
+            const std::size_t index = stack.back();
+            stack.pop_back();
+            if (node.radius <=
+                    separation * std::abs(frequencies(i) - node.centre)) {
+                far_.push_back(index);
+            } else if (node.left == 0) {
+                near_.push_back(index);
+            } else {
+                stack.push_back(node.right);
+                stack.push_back(node.left);
+            }
+        }
+        farBegin_.push_back(far_.size());
+        nearBegin_.push_back(near_.size());
+    }
+}
+
+Cauchy::~Cauchy() {
+}
+
+std::size_t Cauchy::build(const std::size_t begin, const std::size_t end) {
+    const std::size_t index = nodes_.size();
+    nodes_.push_back(Node());
+    Node node;
+    node.begin = begin;
+    node.end   = end;
+    node.left  = node.right = 0;
+    node.centre = sorted_.segment(begin, end - begin).mean();
+    node.radius = 0.0;
+    for (std::size_t m = begin; m < end; ++m) {
+        node.radius = std::max(node.radius,
+                               std::abs(sorted_(m) - node.centre));
+    }
+    if (end - begin > leafSize) {
+        const std::size_t middle = begin + (end - begin) / 2;
+        node.left  = build(begin, middle);
+        node.right = build(middle, end);
+    }
+    nodes_[index] = node;
+    return index;
+}
+
+MatrixXcd Cauchy::multiply(const MatrixXcd& X) const {
+    const std::size_t Ns = frequencies_.size();
+    const std::size_t N  = poles_.size();
+    const std::size_t Nc = X.cols();
+    if ((std::size_t) X.rows() != N) {
+        throw std::runtime_error("There must be a row for each pole");
+    }
+    MatrixXcd res(Ns, Nc);
+    if (dense_) {
+        MatrixXcd K(Ns, N);
+        for (std::size_t m = 0; m < N; ++m) {
+            for (std::size_t i = 0; i < Ns; ++i) {
+                K(i,m) = Complex(1.0, 0) / (frequencies_(i) - poles_(m));
+            }
+        }
+        for (std::size_t n = 0; n < Nc; ++n) {
+            res.col(n) = K * X.col(n);
+        }
+        return res;
+    }
+
+    // Moments of every node, of the poles scaled by its radius:
+    // M_k = sum_m X(m,:) ((p_m - c) / r)^k.
+    std::vector<MatrixXcd> moments(nodes_.size());
+    std::vector<bool> used(nodes_.size(), false);
+    for (std::size_t k = 0; k < far_.size(); ++k) {
+        used[far_[k]] = true;
+    }
+    for (std::size_t j = 0; j < nodes_.size(); ++j) {
+        if (!used[j]) {
+            continue;
+        }
+        const Node& node = nodes_[j];
+        MatrixXcd& M = moments[j];
+        M = MatrixXcd::Zero(terms_, Nc);
+        for (std::size_t m = node.begin; m < node.end; ++m) {
+            const Complex z = node.radius == 0.0 ? Complex(0.0, 0.0) :
+                    (sorted_(m) - node.centre) / node.radius;
+            Complex power(1.0, 0.0);
+            for (std::size_t k = 0; k < terms_; ++k) {
+                M.row(k) += power * X.row(order_[m]);
+                power *= z;
+            }
+        }
+    }
+
+    // 1/(s - p) = sum_k (p - c)^k / (s - c)^(k+1), for |p - c| < |s - c|.
+    RowVectorXcd sum(Nc);
+    for (std::size_t i = 0; i < Ns; ++i) {
+        const Complex s = frequencies_(i);
+        sum.setZero();
+        for (std::size_t k = farBegin_[i]; k < farBegin_[i+1]; ++k) {
+            const Node& node = nodes_[far_[k]];
+            const MatrixXcd& M = moments[far_[k]];
+            const Complex t = Complex(1.0, 0) / (s - node.centre);
+            const Complex q = node.radius * t;
+            Complex factor = t;
+            for (std::size_t j = 0; j < terms_; ++j) {
+                sum += factor * M.row(j);
+                factor *= q;
+            }
+        }
+        for (std::size_t k = nearBegin_[i]; k < nearBegin_[i+1]; ++k) {
+            const Node& node = nodes_[near_[k]];
+            for (std::size_t m = node.begin; m < node.end; ++m) {
+                sum += (Complex(1.0, 0) / (s - sorted_(m)))
+                     * X.row(order_[m]);
+            }
+        }
+        res.row(i) = sum;
+    }
+    return res;
+}
+
+} /* namespace VectorFitting */
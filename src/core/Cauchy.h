@@ -0,0 +1,92 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SEMBA_VECTOR_FITTING_CAUCHY_H_
+#define SEMBA_VECTOR_FITTING_CAUCHY_H_
+
+#include <vector>
+
+#include "VectorFitting.h"
+
+namespace VectorFitting {
+
+/**
+ * Products with the Cauchy matrix K(i,m) = 1/(s_i - p_m) of a set of
+ * frequencies and poles, such as the basis of a model. Poles are grouped in
+ * a binary tree along the imaginary axis; a group far enough from a
+ * frequency, within half its distance, is replaced by a truncated expansion
+ * around its centre (a one dimensional treecode). Each product then costs
+ * O((Ns + N) log N) per column instead of O(Ns N). The terms kept bound the
+ * error of every entry of the product by the tolerance times the sum of the
+ * magnitudes of the terms it adds. Fewer than denseOrder poles, or a zero
+ * tolerance, use the dense product.
+ */
+class Cauchy {
+public:
+    static const std::size_t denseOrder = 128;
+    static const std::size_t leafSize = 16;
+
+    /**
+     * Builds the tree and the interactions of every frequency, shared by
+     * all later products.
+     * @param frequencies   s_i. Size: Ns.
+     * @param poles         p_m. Size: N.
+     * @param tolerance     Relative error of each product, in [0, 1).
+     */
+    Cauchy(const VectorXcd& frequencies,
+           const VectorXcd& poles,
+           const Real tolerance = 0.0);
+    virtual ~Cauchy();
+
+    bool isDense() const {return dense_;}
+    // Terms of the expansions, zero when dense.
+    std::size_t getTerms() const {return terms_;}
+
+    // K*X. X: N, Nc. Result: Ns, Nc.
+    MatrixXcd multiply(const MatrixXcd& X) const;
+
+private:
+    struct Node {
+        std::size_t begin, end;     // Of the sorted poles.
+        std::size_t left, right;    // Children, zero for a leaf.
+        Complex centre;
+        Real radius;
+    };
+
+    VectorXcd frequencies_, poles_;
+    bool dense_;
+    std::size_t terms_;
+    // Sorted poles and their index in poles_.
+    VectorXcd sorted_;
+    std::vector<std::size_t> order_;
+    std::vector<Node> nodes_;
+    // Nodes taken as expansions and leaves summed directly by each
+    // frequency i, from begin[i] to begin[i+1].
+    std::vector<std::size_t> farBegin_, far_;
+    std::vector<std::size_t> nearBegin_, near_;
+
+    std::size_t build(const std::size_t begin, const std::size_t end);
+};
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_CAUCHY_H_ */
@@ -0,0 +1,81 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEMBA_VECTOR_FITTING_CHANNEL_H_
+#define SEMBA_VECTOR_FITTING_CHANNEL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace VectorFitting {
+
+/**
+ * Bounded lock-free queue with any number of producers and consumers.
+ * Values are moved in and out of the slots, so types owning heap buffers
+ * (e.g. Eigen matrices) are handed over without copying their contents.
+ * Capacity is rounded up to a power of two.
+ */
+template<class T>
+class Channel {
+public:
+    explicit Channel(const std::size_t capacity);
+
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    bool tryPush(T&& value);
+    bool tryPop(T& value);
+
+    // Blocking variants. push() waits for a free slot; pop() waits for a
+    // value and returns false only once the channel is closed and drained.
+    void push(T&& value);
+    bool pop(T& value);
+
+    void close();
+    bool isClosed() const;
+
+    std::size_t getCapacity() const;
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    static const std::size_t cacheLine_ = 64;
+
+    std::vector<Slot> slots_;
+    std::size_t mask_;
+
+    char pad0_[cacheLine_];
+    std::atomic<std::size_t> head_;
+    char pad1_[cacheLine_];
+    std::atomic<std::size_t> tail_;
+    char pad2_[cacheLine_];
+    std::atomic<bool> closed_;
+};
+
+} /* namespace VectorFitting */
+
+#include "Channel.hpp"
+
+#endif /* SEMBA_VECTOR_FITTING_CHANNEL_H_ */
@@ -0,0 +1,135 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Channel.h"
+
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace VectorFitting {
+
+// Each slot carries a sequence number telling whose turn it is: a producer
+// may fill it when sequence == position, a consumer may empty it when
+// sequence == position + 1 (D. Vyukov's bounded MPMC queue).
+template<class T>
+Channel<T>::Channel(const std::size_t capacity) {
+    if (capacity == 0) {
+        throw std::runtime_error("Channel capacity cannot be zero");
+    }
+    std::size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    slots_ = std::vector<Slot>(size);
+    mask_ = size - 1;
+    for (std::size_t i = 0; i < size; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    closed_.store(false, std::memory_order_relaxed);
+}
+
+template<class T>
+bool Channel<T>::tryPush(T&& value) {
+    std::size_t pos = tail_.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &slots_[pos & mask_];
+        const std::size_t seq = slot->sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t dif = (std::ptrdiff_t) seq - (std::ptrdiff_t) pos;
+        if (dif == 0) {
+            if (tail_.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (dif < 0) {
+            return false; // Full.
+        } else {
+            pos = tail_.load(std::memory_order_relaxed);
+        }
+    }
+    slot->value = std::move(value);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+template<class T>
+bool Channel<T>::tryPop(T& value) {
+    std::size_t pos = head_.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &slots_[pos & mask_];
+        const std::size_t seq = slot->sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t dif =
+                (std::ptrdiff_t) seq - (std::ptrdiff_t) (pos + 1);
+        if (dif == 0) {
+            if (head_.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (dif < 0) {
+            return false; // Empty.
+        } else {
+            pos = head_.load(std::memory_order_relaxed);
+        }
+    }
+    value = std::move(slot->value);
+    slot->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+}
+
+template<class T>
+void Channel<T>::push(T&& value) {
+    while (!tryPush(std::move(value))) {
+        std::this_thread::yield();
+    }
+}
+
+template<class T>
+bool Channel<T>::pop(T& value) {
+    while (!tryPop(value)) {
+        if (isClosed()) {
+            // Values pushed before close() must still be delivered.
+            return tryPop(value);
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+template<class T>
+void Channel<T>::close() {
+    closed_.store(true, std::memory_order_release);
+}
+
+template<class T>
+bool Channel<T>::isClosed() const {
+    return closed_.load(std::memory_order_acquire);
+}
+
+template<class T>
+std::size_t Channel<T>::getCapacity() const {
+    return slots_.size();
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,322 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "CostModel.h"
+#include "SpaceGenerator.h"
+#include "Tuning.h"
+#include "VectorFitting.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace VectorFitting {
+
+namespace {
+
+// Flops of the Householder QR of a m x n matrix, m >= n.
+Real getQRFlops(const Real m, const Real n) {
+    return 2.0*m*n*n - 2.0*n*n*n/3.0;
+}
+
+// Rational functions with N/2 complex pairs, Nc responses and Ns samples.
+std::vector<Sample> buildSamples(const std::size_t Ns,
+                                 const std::size_t N,
+                                 const std::size_t Nc) {
+    std::vector<Real> w = logspace(std::pair<Real,Real>(0.0, 4.0), Ns);
+    std::vector<Sample> res(Ns);
+    for (std::size_t k = 0; k < Ns; ++k) {
+        const Complex s(0.0, 2.0 * M_PI * w[k]);
+        std::vector<Complex> f(Nc, Complex(0.5, 0.0));
+        for (std::size_t n = 0; n < Nc; ++n) {
+            for (std::size_t m = 0; m < N/2; ++m) {
+                const Complex pole(-10.0*(m+1), 2.0*M_PI*std::pow(10.0,
+                        4.0*(m+0.5)/(N/2)));
+                const Complex residue((Real) (n+1), (Real) (m+1));
+                f[n] += residue / (s - pole)
+                      + std::conj(residue) / (s - std::conj(pole));
+            }
+        }
+        res[k] = Sample(s, f);
+    }
+    return res;
+}
+
+// Sets the OpenMP threads of the calling thread, used by Eigen's products,
+// while alive.
+class ThreadsScope {
+public:
+    explicit ThreadsScope(const std::size_t threads) : threads_(0) {
+#ifdef _OPENMP
+        threads_ = omp_get_max_threads();
+        omp_set_num_threads((int) threads);
+#else
+        (void) threads;
+#endif
+    }
+    ~ThreadsScope() {
+#ifdef _OPENMP
+        omp_set_num_threads(threads_);
+#endif
+    }
+private:
+    int threads_;
+};
+
+// Mean seconds of the fits on the given threads done in about a tenth of a
+// second. Each one includes the single model evaluation of getResult(), the
+// errorFlops of estimate().
+Real timeFit(const std::vector<Sample>& samples, const std::size_t N,
+             const std::size_t threads) {
+    const ThreadsScope scope(threads);
+    typedef std::chrono::steady_clock Clock;
+    const std::vector<Complex> poles =
+            VectorFitting::getStartingPoles(samples, N);
+    std::size_t runs = 0;
+    const Clock::time_point start = Clock::now();
+    Real elapsed = 0.0;
+    do {
+        VectorFitting fitting(samples, poles, Options());
+        fitting.setThreads(threads);
+        fitting.fit();
+        fitting.getResult();
+        runs++;
+        elapsed = std::chrono::duration<Real>(Clock::now() - start).count();
+    } while (elapsed < 0.1);
+    return elapsed / (Real) runs;
+}
+
+} /* namespace */
+
+CostModel::Problem::Problem() {
+    Ns = N = Nc = 0;
+    frozen = 0;
+    threads = 0;
+}
+
+CostModel::Estimate::Estimate() {
+    basisFlops = poleFlops = solveFlops = eigenFlops = residueFlops = 0.0;
+    errorFlops = 0.0;
+    dataBytes = basisBytes = responseBytes = reducedBytes = residueBytes = 0;
+    seconds = 0.0;
+}
+
+Real CostModel::Estimate::getFlops() const {
+    return basisFlops + poleFlops + solveFlops + eigenFlops + residueFlops
+         + errorFlops;
+}
+
+std::size_t CostModel::Estimate::getPeakBytes() const {
+    return dataBytes + std::max(basisBytes + responseBytes + reducedBytes,
+                                residueBytes);
+}
+
+CostModel::CostModel() {
+    const Tuning& tuning = Tuning::get();
+    flopRate_           = tuning.flopRate;
+    parallelEfficiency_ = tuning.parallelEfficiency;
+    overhead_           = tuning.overhead;
+}
+
+CostModel::~CostModel() {
+}
+
+Real CostModel::getFlopRate() const {
+    return flopRate_;
+}
+
+Real CostModel::getParallelEfficiency() const {
+    return parallelEfficiency_;
+}
+
+Real CostModel::getOverhead() const {
+    return overhead_;
+}
+
+void CostModel::setFlopRate(const Real flopRate) {
+    if (flopRate <= 0.0) {
+        throw std::runtime_error("Flop rate must be positive");
+    }
+    flopRate_ = flopRate;
+}
+
+void CostModel::setParallelEfficiency(const Real efficiency) {
+    if (efficiency <= 0.0 || efficiency > 1.0) {
+        throw std::runtime_error("Parallel efficiency must be in (0, 1]");
+    }
+    parallelEfficiency_ = efficiency;
+}
+
+void CostModel::setOverhead(const Real seconds) {
+    if (seconds < 0.0) {
+        throw std::runtime_error("Overhead can not be negative");
+    }
+    overhead_ = seconds;
+}
+
+CostModel::Estimate CostModel::estimate(const Problem& problem) const {
+    const Real Ns = (Real) problem.Ns;
+    const Real N  = (Real) problem.N;
+    const Real Nc = (Real) problem.Nc;
+    const Real Nf = (Real) (problem.N - problem.frozen);
+    Real offs = 0.0;
+    switch (problem.options.getAsymptoticTrend()) {
+    case Options::zero:
+        offs = 0.0;
+        break;
+    case Options::constant:
+        offs = 1.0;
+        break;
+    case Options::linear:
+        offs = 2.0;
+        break;
+    }
+    const std::size_t threads = std::max<std::size_t>(1,
+            std::min(getThreads(problem.threads), problem.Nc));
+    const std::size_t real = sizeof(Real), complex = 2*sizeof(Real);
+
+    Estimate res;
+    // Frequencies, responses and weights, the only copy kept by SampleSet.
+    res.dataBytes = problem.Ns * complex
+                  + problem.Ns * problem.Nc * (complex + real);
+    res.errorFlops = 11.0*Ns*N + 8.0*Ns*Nc*N;
+
+    Real parallelFlops = 0.0;
+    if (!problem.options.isSkipPoleIdentification() &&
+            problem.frozen < problem.N) {
+        // Per response: system of 2Ns+1 rows, its QR, thin Q and Q^T A, or
+        // its Gram matrix and Cholesky, and the TSQR merge of the
+        // (Nf+1) x (Nf+1) block of the Nf free poles.
+        const Real m = 2.0*Ns + 1.0, n = N + offs + Nf + 1.0, k = Nf + 1.0;
+        const bool normal =
+                problem.options.getSolver() == Options::normalEquations;
+        const Real reduction = normal ?
+                m*n*n + n*n*n/3.0 + n*n :
+                getQRFlops(m, n) + 2.0*getQRFlops(m, n) + 2.0*m*n*n;
+        const Real perResponse = 8.0*Ns*n + reduction
+                + getQRFlops(2.0*k, k) + 8.0*k*k;
+        parallelFlops += Nc * perResponse;
+        res.basisFlops += 22.0*Ns*N;
+        res.poleFlops   = parallelFlops;
+        res.solveFlops  = getQRFlops(k, k) + 2.0*k*k;
+        res.eigenFlops  = 10.0*Nf*Nf*Nf + 2.0*Nf*Nf;
+
+        const std::size_t rows = 2*problem.Ns + 1;
+        const std::size_t K = problem.N - problem.frozen + 1;
+        const std::size_t cols = problem.N + (std::size_t) offs + K;
+        res.basisBytes    = problem.Ns * (problem.N + 2) * complex;
+        const std::size_t system = problem.options.getSolver() ==
+                Options::normalEquations ?
+                rows*cols + 3*cols*cols : 4*rows*cols + cols;
+        res.responseBytes = threads * (system + problem.Ns) * real;
+        res.reducedBytes  = (threads + 1) * 5*K*K * real;
+    }
+    if (!problem.options.isSkipResidueIdentification()) {
+        // Real system of 2Ns rows for each response, in parallel over the
+        // responses, column norms of all of them in a single product.
+        const Real m = 2.0*Ns, p = N + offs;
+        res.basisFlops  += 22.0*Ns*N;
+        res.residueFlops = Nc * (getQRFlops(m, p) + 6.0*m*p);
+        parallelFlops   += res.residueFlops;
+
+        const std::size_t cols = problem.N + (std::size_t) offs;
+        res.residueBytes = (problem.Ns * cols + problem.Nc * problem.N)
+                         * complex
+                         + (threads * (2*problem.Ns * cols + 2*problem.Ns)
+                         + problem.Nc * cols) * real;
+    }
+
+    const Real serialFlops = res.getFlops() - parallelFlops;
+    Real effective = (Real) threads;
+    if (threads > 1) {
+        effective *= parallelEfficiency_;
+    }
+    res.seconds = overhead_
+            + serialFlops / flopRate_
+            + parallelFlops / (flopRate_ * effective);
+    return res;
+}
+
+void CostModel::calibrate() {
+    // Two sizes separate the fixed cost from the throughput.
+    const std::size_t smallN = 4, largeN = 30;
+    const std::vector<Sample> small = buildSamples(50, smallN, 1);
+    const std::vector<Sample> large = buildSamples(400, largeN, 4);
+    const Real smallSeconds = timeFit(small, smallN, 1);
+    const Real largeSeconds = timeFit(large, largeN, 1);
+
+    Problem problem;
+    problem.threads = 1;
+    problem.Ns = small.size();
+    problem.N  = smallN;
+    problem.Nc = 1;
+    const Real smallFlops = estimate(problem).getFlops();
+    problem.Ns = large.size();
+    problem.N  = largeN;
+    problem.Nc = 4;
+    const Real largeFlops = estimate(problem).getFlops();
+
+    if (largeSeconds > smallSeconds) {
+        flopRate_ = (largeFlops - smallFlops) / (largeSeconds - smallSeconds);
+    } else {
+        flopRate_ = largeFlops / largeSeconds;
+    }
+    overhead_ = std::max<Real>(0.0, smallSeconds - smallFlops / flopRate_);
+
+    const std::size_t maxThreads = getThreads(0);
+    if (maxThreads > 1) {
+        problem.Nc      = 4 * maxThreads;
+        problem.threads = maxThreads;
+        const Real measured = timeFit(
+                buildSamples(problem.Ns, largeN, problem.Nc), largeN,
+                maxThreads);
+        // Splits the predicted time into its serial and parallel parts,
+        // the slowdown over the ideal speedup is charged to the latter.
+        const Real T = (Real) maxThreads;
+        parallelEfficiency_ = 1.0;
+        const Real ideal = estimate(problem).seconds;
+        problem.threads = 1;
+        const Real sequential = estimate(problem).seconds;
+        const Real parallel = (sequential - ideal) * T / (T - 1.0);
+        const Real serial = sequential - parallel;
+        if (measured > serial) {
+            parallelEfficiency_ = std::min<Real>(1.0, std::max<Real>(0.05,
+                    parallel / T / (measured - serial)));
+        }
+    }
+}
+
+std::size_t CostModel::getThreads(const std::size_t threads) {
+    if (threads != 0) {
+        return threads;
+    }
+#ifdef _OPENMP
+    return (std::size_t) omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+} /* namespace VectorFitting */
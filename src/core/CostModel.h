@@ -0,0 +1,97 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEMBA_VECTOR_FITTING_COSTMODEL_H_
+#define SEMBA_VECTOR_FITTING_COSTMODEL_H_
+
+#include <cstddef>
+
+#include "Options.h"
+#include "Real.h"
+
+namespace VectorFitting {
+
+/**
+ * Predicts the resources taken by one call to VectorFitting::fit() before
+ * running it, so that schedulers can pack fits without running out of memory
+ * or leaving cores idle. Flops and memory follow from the problem sizes;
+ * wall time also needs the throughput of the host, given by calibrate().
+ */
+class CostModel {
+public:
+    struct Problem {
+        Problem();
+        std::size_t Ns, N, Nc;
+        std::size_t frozen;     // Poles left out of pole identification.
+        Options options;
+        std::size_t threads;    // Zero for the OpenMP default.
+    };
+
+    struct Estimate {
+        Estimate();
+        Real basisFlops, poleFlops, solveFlops, eigenFlops, residueFlops;
+        Real errorFlops;
+        // Bytes held at the same time, the peak is the largest stage.
+        std::size_t dataBytes;      // Sample set, see SampleSet.
+        std::size_t basisBytes;     // Dk.
+        std::size_t responseBytes;  // Per response system, once per thread.
+        std::size_t reducedBytes;   // AA and its reduction workspace.
+        std::size_t residueBytes;   // Residue identification system.
+        Real seconds;
+
+        Real getFlops() const;
+        std::size_t getPeakBytes() const;
+    };
+
+    CostModel();
+    virtual ~CostModel();
+
+    // Flops per second of a single thread.
+    Real getFlopRate() const;
+    // Fraction of the ideal speedup reached by parallel sections.
+    Real getParallelEfficiency() const;
+    // Fixed cost of a call, independent of the sizes.
+    Real getOverhead() const;
+
+    void setFlopRate(const Real flopRate);
+    void setParallelEfficiency(const Real efficiency);
+    void setOverhead(const Real seconds);
+
+    Estimate estimate(const Problem& problem) const;
+
+    /**
+     * Measures this host by timing fits of synthetic data, it takes a
+     * fraction of a second. Fits are given their threads explicitly, the
+     * tuning profile is left alone.
+     */
+    void calibrate();
+
+private:
+    Real flopRate_;
+    Real parallelEfficiency_;
+    Real overhead_;
+
+    static std::size_t getThreads(const std::size_t threads);
+};
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_COSTMODEL_H_ */
@@ -0,0 +1,199 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Counters.h"
+
+#include <atomic>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+#endif
+
+namespace VectorFitting {
+
+namespace {
+
+std::atomic<bool> enabled(false);
+
+#ifdef __linux__
+
+// Whether the core PMU has FP_ARITH_INST_RETIRED (event 0xC7), from
+// Broadwell on. Hybrid and Atom parts are left out: their raw events do not
+// map to a single core type.
+bool hasFloatingPointEvent() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(0, &eax, &ebx, &ecx, &edx) == 0) {
+        return false;
+    }
+    char vendor[13];
+    std::memcpy(vendor,     &ebx, 4);
+    std::memcpy(vendor + 4, &edx, 4);
+    std::memcpy(vendor + 8, &ecx, 4);
+    vendor[12] = '\0';
+    if (std::strcmp(vendor, "GenuineIntel") != 0 ||
+            __get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0 ||
+            ((eax >> 8) & 0xF) != 6) {
+        return false;
+    }
+    const unsigned int model = ((eax >> 4) & 0xF) | ((eax >> 12) & 0xF0);
+    switch (model) {
+    case 0x3D: case 0x47: case 0x4F: case 0x56:     // Broadwell.
+    case 0x4E: case 0x5E: case 0x55:                // Skylake, Cascade Lake.
+    case 0x8E: case 0x9E: case 0xA5: case 0xA6:     // Kaby, Coffee, Comet.
+    case 0x66: case 0x7D: case 0x7E: case 0x6A:     // Cannon, Ice Lake.
+    case 0x6C: case 0x8C: case 0x8D: case 0xA7:     // Tiger, Rocket Lake.
+    case 0x8F: case 0xCF:                           // Sapphire, Emerald.
+        return true;
+    default:
+        return false;
+    }
+#else
+    return false;
+#endif
+}
+
+int openEvent(const std::uint32_t type, const std::uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size   = sizeof(attr);
+    attr.type   = type;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    // Scaled by the time counted when the PMU is multiplexed.
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+// Descriptors of a thread, -1 for the events it can not count.
+struct Group {
+    bool opened;
+    int fds[Counters::numberOfEvents];
+
+    Group() : opened(false) {
+        for (int e = 0; e < Counters::numberOfEvents; ++e) {
+            fds[e] = -1;
+        }
+    }
+    ~Group() {
+        for (int e = 0; e < Counters::numberOfEvents; ++e) {
+            if (fds[e] >= 0) {
+                close(fds[e]);
+            }
+        }
+    }
+
+    void open() {
+        if (opened) {
+            return;
+        }
+        opened = true;
+        fds[Counters::cycles] =
+                openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        fds[Counters::instructions] =
+                openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        fds[Counters::cacheReferences] =
+                openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES);
+        fds[Counters::cacheMisses] =
+                openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        if (hasFloatingPointEvent()) {
+            // FP_ARITH_INST_RETIRED, all its scalar and packed umasks.
+            fds[Counters::floatingPoint] = openEvent(PERF_TYPE_RAW, 0xFFC7);
+        }
+    }
+};
+
+thread_local Group group;
+
+#endif
+
+} /* namespace */
+
+void Counters::setEnabled(const bool value) {
+    enabled = value;
+}
+
+bool Counters::isEnabled() {
+    return enabled;
+}
+
+bool Counters::isAvailable(const Event event) {
+#ifdef __linux__
+    group.open();
+    return group.fds[event] >= 0;
+#else
+    (void) event;
+    return false;
+#endif
+}
+
+void Counters::read(std::uint64_t values[numberOfEvents]) {
+    for (int e = 0; e < numberOfEvents; ++e) {
+        values[e] = 0;
+    }
+    if (!enabled) {
+        return;
+    }
+#ifdef __linux__
+    group.open();
+    for (int e = 0; e < numberOfEvents; ++e) {
+        std::uint64_t data[3];  // Value, time enabled and time running.
+        if (group.fds[e] < 0 ||
+                ::read(group.fds[e], data, sizeof(data)) != sizeof(data)) {
+            continue;
+        }
+        if (data[2] == 0) {
+            continue;
+        }
+        values[e] = data[2] < data[1] ?
+                (std::uint64_t) ((double) data[0] * data[1] / data[2]) :
+                data[0];
+    }
+#endif
+}
+
+const char* Counters::getName(const Event event) {
+    switch (event) {
+    case cycles:
+        return "cycles";
+    case instructions:
+        return "instructions";
+    case cacheReferences:
+        return "cacheReferences";
+    case cacheMisses:
+        return "cacheMisses";
+    case floatingPoint:
+        return "floatingPoint";
+    default:
+        return "unknown";
+    }
+}
+
+} /* namespace VectorFitting */
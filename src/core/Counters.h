@@ -0,0 +1,66 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SEMBA_VECTOR_FITTING_COUNTERS_H_
+#define SEMBA_VECTOR_FITTING_COUNTERS_H_
+
+#include <cstdint>
+
+namespace VectorFitting {
+
+/**
+ * Hardware performance counters of the calling thread, read through
+ * perf_event_open on Linux: cycles, instructions, last level cache
+ * references and misses and, on Intel cores from Broadwell on, retired
+ * floating point instructions. Counting is off until enabled; each thread
+ * opens its own counters on its first read. Events refused by the kernel,
+ * the processor, a virtual machine or perf_event_paranoid read as zero, as
+ * does everything on other systems; isAvailable() tells them apart from
+ * real zeros. Counters only see the thread that reads them, so phases run
+ * in parallel count the share of the calling thread.
+ */
+class Counters {
+public:
+    enum Event {
+        cycles,
+        instructions,
+        cacheReferences,    // Last level cache.
+        cacheMisses,
+        floatingPoint,      // Instructions, of any vector width.
+        numberOfEvents
+    };
+
+    static void setEnabled(const bool enabled);
+    static bool isEnabled();
+
+    // Whether the calling thread counts the event.
+    static bool isAvailable(const Event event);
+
+    // Totals of the calling thread, zero while disabled.
+    static void read(std::uint64_t values[numberOfEvents]);
+
+    static const char* getName(const Event event);
+};
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_COUNTERS_H_ */
@@ -0,0 +1,161 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Datasets.h"
+#include "Importer.h"
+#include "SpaceGenerator.h"
+
+#include <cmath>
+
+namespace VectorFitting {
+
+namespace {
+
+// Poles and residues of section 4 of Gustavsen and Semlyen, 1999.
+void getSection4Model(std::vector<Complex>& p, std::vector<Complex>& r) {
+    const Real data[][4] = {
+            {-4500,      0, -3000,      0},
+            {-41000,     0, -83000,     0},
+            {-100,  5000,  -5,     7000},
+            {-120,  15000, -20,    18000},
+            {-3000, 35000,  6000,  45000},
+            {-200,  45000,  40,    60000},
+            {-1500, 45000,  90,    10000},
+            {-500,  70000,  50000, 80000},
+            {-1000, 73000,  1000,  45000},
+            {-2000, 90000, -5000,  92000}};
+    p.clear();
+    r.clear();
+    for (std::size_t i = 0; i < 10; ++i) {
+        p.push_back(Complex(data[i][0], data[i][1]));
+        r.push_back(Complex(data[i][2], data[i][3]));
+        if (data[i][1] != 0.0) {
+            p.push_back(std::conj(p.back()));
+            r.push_back(std::conj(r.back()));
+        }
+    }
+}
+
+} /* namespace */
+
+Dataset Datasets::getEx1() {
+    Dataset res;
+    res.name = "ex1";
+    res.order = 4;
+    res.trend = Options::linear;
+    const std::vector<Real> f =
+            logspace(std::pair<Real,Real>(0.0, 4.0), (std::size_t) 101);
+    res.samples.resize(f.size());
+    for (std::size_t k = 0; k < f.size(); ++k) {
+        const Complex s(0.0, 2.0 * M_PI * f[k]);
+        res.samples[k] = Sample(s, std::vector<Complex>(1,
+                  2.0 / (s + 5.0)
+                + Complex(30.0,  40.0) / (s - Complex(-100.0,  500.0))
+                + Complex(30.0, -40.0) / (s - Complex(-100.0, -500.0))
+                + 0.5));
+    }
+    return res;
+}
+
+Dataset Datasets::getEx2() {
+    Dataset res;
+    res.name = "ex2";
+    res.order = 18;
+    res.trend = Options::linear;
+    std::vector<Complex> p, r;
+    getSection4Model(p, r);
+    const std::vector<Real> f =
+            linspace(std::pair<Real,Real>(1.0, 1e5), 100);
+    res.samples.resize(f.size());
+    for (std::size_t k = 0; k < f.size(); ++k) {
+        const Complex s(0.0, 2.0 * M_PI * f[k]);
+        std::vector<Complex> y(2, 0.0);
+        for (std::size_t n = 0; n < p.size(); ++n) {
+            const Complex pole = 2.0 * M_PI * p[n];
+            const Complex residue = 2.0 * M_PI * r[n];
+            if (n < 10) {
+                y[0] += residue / (s - pole);
+            }
+            if (n >= 8) {
+                y[1] += residue / (s - pole);
+            }
+        }
+        y[0] += s * 2e-5 + 3.0 * 0.2;
+        y[1] += s * 6e-5;
+        res.samples[k] = Sample(s, y);
+    }
+    return res;
+}
+
+Dataset Datasets::getPaperSection4() {
+    Dataset res;
+    res.name = "paperSection4";
+    res.order = 18;
+    res.trend = Options::linear;
+    std::vector<Complex> p, r;
+    getSection4Model(p, r);
+    const std::vector<Real> f =
+            linspace(std::pair<Real,Real>(1.0, 1e5), 100);
+    res.samples.resize(f.size());
+    for (std::size_t k = 0; k < f.size(); ++k) {
+        const Complex s(0.0, 2.0 * M_PI * f[k]);
+        Complex y = 0.2 + s * 2e-5;
+        for (std::size_t n = 0; n < p.size(); ++n) {
+            y += r[n] / (s - p[n]);
+        }
+        res.samples[k] = Sample(s, std::vector<Complex>(1, y));
+    }
+    return res;
+}
+
+std::vector<Dataset> Datasets::getReferences() {
+    std::vector<Dataset> res;
+    res.push_back(getEx1());
+    res.push_back(getEx2());
+    res.push_back(getPaperSection4());
+    return res;
+}
+
+Dataset Datasets::read(const std::string& filename,
+                       const std::size_t order,
+                       const Options::AsymptoticTrend trend) {
+    Dataset res;
+    const std::size_t slash = filename.find_last_of("/\\");
+    res.name = (slash == std::string::npos) ? filename
+                                            : filename.substr(slash + 1);
+    res.samples = Importer::readSamples(filename);
+    res.order = order;
+    res.trend = trend;
+    return res;
+}
+
+Dataset Datasets::generate(const Generator& generator,
+                           const std::string& name) {
+    Dataset res;
+    res.name = name;
+    res.samples = generator.getSamples();
+    res.order = generator.getOrder();
+    res.trend = generator.getAsymptoticTrend();
+    return res;
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,72 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SEMBA_VECTOR_FITTING_DATASETS_H_
+#define SEMBA_VECTOR_FITTING_DATASETS_H_
+
+#include <string>
+#include <vector>
+
+#include "Generator.h"
+#include "VectorFitting.h"
+
+namespace VectorFitting {
+
+// Samples together with the order and trend they are meant to be fitted at.
+struct Dataset {
+    std::string name;
+    std::vector<Sample> samples;
+    std::size_t order;
+    Options::AsymptoticTrend trend;
+
+    Dataset() : order(0), trend(Options::constant) {}
+};
+
+/**
+ * Known-pole reference problems shared by the benchmark apps. ex1 and ex2
+ * are the examples of the original vectfit3 distribution, paperSection4 the
+ * model of section 4 of Gustavsen and Semlyen, 1999; all of them are
+ * fitted exactly at their order.
+ */
+class Datasets {
+public:
+    static Dataset getEx1();
+    static Dataset getEx2();
+    static Dataset getPaperSection4();
+
+    // ex1, ex2 and paperSection4.
+    static std::vector<Dataset> getReferences();
+
+    // Samples read with Importer, named after the file.
+    static Dataset read(const std::string& filename,
+                        const std::size_t order,
+                        const Options::AsymptoticTrend trend =
+                                Options::constant);
+
+    // Fitted at the order and trend of the generated model.
+    static Dataset generate(const Generator& generator,
+                            const std::string& name = "synthetic");
+};
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_DATASETS_H_ */
@@ -0,0 +1,167 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Exporter.h"
+#include "Trace.h"
+
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace VectorFitting {
+
+const char Exporter::samplesMagic[8] = {'V','F','S','M','P','L','0','1'};
+const char Exporter::modelsMagic[8]  = {'V','F','M','O','D','L','0','1'};
+
+namespace {
+
+void writeUInt(std::ostream& output, const std::size_t value) {
+    const uint64_t v = value;
+    output.write(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void writeReal(std::ostream& output, const Real value) {
+    const double v = value;
+    output.write(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void writeComplex(std::ostream& output, const Complex& value) {
+    writeReal(output, value.real());
+    writeReal(output, value.imag());
+}
+
+} /* namespace */
+
+void Exporter::writeSamples(const std::string& filename,
+                            const std::vector<Sample>& samples) {
+    Trace::Scope trace("writeSamples", "io");
+    std::ofstream file(filename.c_str(), std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open " + filename);
+    }
+    const std::size_t Nc = samples.empty() ? 0 : samples.front().second.size();
+    writeSamplesHeader(file, samples.size(), Nc);
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        writeSample(file, samples[i]);
+    }
+}
+
+void Exporter::writeModels(const std::string& filename,
+                           const std::vector<Result>& models,
+                           Format format) {
+    Trace::Scope trace("writeModels", "io");
+    std::ofstream file;
+    if (format == binary) {
+        file.open(filename.c_str(), std::ios::binary);
+    } else {
+        file.open(filename.c_str());
+    }
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open " + filename);
+    }
+    if (format == binary) {
+        file.write(modelsMagic, sizeof(modelsMagic));
+        writeUInt(file, models.size());
+    }
+    for (std::size_t i = 0; i < models.size(); ++i) {
+        if (format == binary) {
+            writeModel(file, models[i]);
+        } else {
+            writeModelText(file, models[i]);
+        }
+    }
+}
+
+void Exporter::writeSamplesHeader(std::ostream& output,
+                                  const std::size_t Ns,
+                                  const std::size_t Nc) {
+    output.write(samplesMagic, sizeof(samplesMagic));
+    writeUInt(output, Ns);
+    writeUInt(output, Nc);
+}
+
+void Exporter::writeSample(std::ostream& output, const Sample& sample) {
+    writeComplex(output, sample.first);
+    for (std::size_t j = 0; j < sample.second.size(); ++j) {
+        writeComplex(output, sample.second[j]);
+    }
+}
+
+void Exporter::writeModel(std::ostream& output, const Result& model) {
+    const std::size_t N  = model.poles.size();
+    const std::size_t Nc = model.residues.rows();
+    writeUInt(output, model.id);
+    writeUInt(output, N);
+    writeUInt(output, Nc);
+    writeReal(output, model.rmse);
+    writeReal(output, model.maxDeviation);
+    for (std::size_t m = 0; m < N; ++m) {
+        writeComplex(output, model.poles(m));
+    }
+    for (std::size_t n = 0; n < Nc; ++n) {
+        for (std::size_t m = 0; m < N; ++m) {
+            writeComplex(output, model.residues(n,m));
+        }
+    }
+    for (std::size_t n = 0; n < Nc; ++n) {
+        writeComplex(output, n < (std::size_t) model.D.size() ?
+                model.D(n) : Complex(0.0, 0.0));
+    }
+    for (std::size_t n = 0; n < Nc; ++n) {
+        writeComplex(output, n < (std::size_t) model.E.size() ?
+                model.E(n) : Complex(0.0, 0.0));
+    }
+}
+
+void Exporter::writeModelText(std::ostream& output, const Result& model) {
+    const std::size_t N  = model.poles.size();
+    const std::size_t Nc = model.residues.rows();
+    output << std::setprecision(16) << std::scientific;
+    output << "model " << model.id << " order " << N
+           << " responses " << Nc
+           << " rmse " << model.rmse
+           << " maxDeviation " << model.maxDeviation << std::endl;
+    output << "poles" << std::endl;
+    for (std::size_t m = 0; m < N; ++m) {
+        output << model.poles(m).real() << " "
+               << model.poles(m).imag() << std::endl;
+    }
+    output << "residues" << std::endl;
+    for (std::size_t n = 0; n < Nc; ++n) {
+        for (std::size_t m = 0; m < N; ++m) {
+            output << model.residues(n,m).real() << " "
+                   << model.residues(n,m).imag()
+                   << (m + 1 < N ? " " : "");
+        }
+        output << std::endl;
+    }
+    output << "D E" << std::endl;
+    for (std::size_t n = 0; n < Nc; ++n) {
+        const Complex d = n < (std::size_t) model.D.size() ?
+                model.D(n) : Complex(0.0, 0.0);
+        const Complex e = n < (std::size_t) model.E.size() ?
+                model.E(n) : Complex(0.0, 0.0);
+        output << d.real() << " " << d.imag() << " "
+               << e.real() << " " << e.imag() << std::endl;
+    }
+}
+
+} /* namespace VectorFitting */
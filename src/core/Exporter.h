@@ -0,0 +1,69 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEMBA_VECTOR_FITTING_EXPORTER_H_
+#define SEMBA_VECTOR_FITTING_EXPORTER_H_
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "VectorFitting.h"
+
+namespace VectorFitting {
+
+/**
+ * Binary layouts, all values stored as native doubles and 64 bit integers:
+ *  - Samples: magic, Ns, Nc and, for each sample, s followed by its Nc
+ *    responses, each complex number as a real and imaginary pair.
+ *  - Models: magic, number of models and, for each one, id, N, Nc, rmse,
+ *    max deviation, poles, residues (row by row), D and E.
+ */
+class Exporter {
+public:
+    enum Format {
+        binary,
+        text
+    };
+
+    static const char samplesMagic[8];
+    static const char modelsMagic[8];
+
+    static void writeSamples(const std::string& filename,
+                             const std::vector<Sample>& samples);
+    static void writeModels(const std::string& filename,
+                            const std::vector<Result>& models,
+                            Format format = binary);
+
+    // Streaming pieces of the binary samples layout.
+    static void writeSamplesHeader(std::ostream& output,
+                                   const std::size_t Ns,
+                                   const std::size_t Nc);
+    static void writeSample(std::ostream& output, const Sample& sample);
+
+    // A single model record, as found in the binary models layout.
+    static void writeModel(std::ostream& output, const Result& model);
+    static void writeModelText(std::ostream& output, const Result& model);
+};
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_EXPORTER_H_ */
@@ -0,0 +1,253 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Generator.h"
+#include "Exporter.h"
+#include "SpaceGenerator.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+namespace VectorFitting {
+
+const std::size_t Generator::blockSize_;
+
+namespace {
+
+// SplitMix64 finalizer, decorrelates the streams of nearby seeds.
+uint64_t mix(const uint64_t seed, const uint64_t stream) {
+    uint64_t z = seed + (stream + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+} /* namespace */
+
+Generator::Generator(const std::size_t seed) {
+    seed_ = seed;
+    Ns_ = 1000;
+    Nc_ = 1;
+    N_ = 10;
+    range_ = std::pair<Real, Real>(1e2, 1e5);
+    trend_ = Options::constant;
+    conditioning_ = 1e2;
+    noise_ = 0.0;
+    clustering_ = 0.0;
+    clusterWidth_ = 0.1;
+}
+
+void Generator::setSamplesSize(const std::size_t Ns) {
+    if (Ns == 0) {
+        throw std::runtime_error("Samples size cannot be zero");
+    }
+    Ns_ = Ns;
+}
+
+void Generator::setResponseSize(const std::size_t Nc) {
+    if (Nc == 0) {
+        throw std::runtime_error("Response size cannot be zero");
+    }
+    Nc_ = Nc;
+}
+
+void Generator::setOrder(const std::size_t N) {
+    N_ = N;
+}
+
+void Generator::setFrequencyRange(const std::pair<Real, Real>& range) {
+    if (range.first <= 0.0 || range.second < range.first) {
+        throw std::runtime_error("Invalid frequency range");
+    }
+    range_ = range;
+}
+
+void Generator::setAsymptoticTrend(const Options::AsymptoticTrend trend) {
+    trend_ = trend;
+}
+
+void Generator::setConditioning(const Real conditioning) {
+    if (conditioning < 1.0) {
+        throw std::runtime_error("Conditioning must be at least one");
+    }
+    conditioning_ = conditioning;
+}
+
+void Generator::setNoise(const Real noise) {
+    if (noise < 0.0) {
+        throw std::runtime_error("Noise cannot be negative");
+    }
+    noise_ = noise;
+}
+
+void Generator::setClustering(const Real fraction, const Real width) {
+    if (fraction < 0.0 || fraction > 1.0 || width <= 0.0 || width >= 1.0) {
+        throw std::runtime_error("Invalid clustering");
+    }
+    clustering_ = fraction;
+    clusterWidth_ = width;
+}
+
+Result Generator::getModel() const {
+    std::mt19937_64 rng(mix(seed_, 0));
+    std::uniform_real_distribution<Real> uniform(0.0, 1.0);
+    const Real low  = std::log10(range_.first);
+    const Real high = std::log10(range_.second);
+    auto randomFrequency = [&]() {
+        return std::pow((Real) 10.0, low + (high - low) * uniform(rng));
+    };
+
+    // Damping ratios between 1e-3 and 1e-1.
+    const std::size_t pairs = N_ / 2;
+    const std::size_t clustered =
+            (std::size_t) std::floor(clustering_ * pairs + 0.5);
+    const Real centre = randomFrequency();
+    std::vector<Real> f(pairs);
+    for (std::size_t i = 0; i < pairs; ++i) {
+        if (i < clustered) {
+            f[i] = centre * (1.0 + clusterWidth_ * (2.0*uniform(rng) - 1.0));
+        } else {
+            f[i] = randomFrequency();
+        }
+    }
+    std::sort(f.begin(), f.end());
+
+    Result res;
+    res.poles = Eigen::VectorXcd::Zero(N_);
+    std::size_t m = 0;
+    if (N_ % 2 == 1) {
+        res.poles(m++) = - 2.0 * M_PI * randomFrequency();
+    }
+    for (std::size_t i = 0; i < pairs; ++i) {
+        const Real w = 2.0 * M_PI * f[i];
+        const Real zeta = std::pow((Real) 10.0, -3.0 + 2.0 * uniform(rng));
+        res.poles(m)   = Complex(- zeta * w, w);
+        res.poles(m+1) = std::conj(res.poles(m));
+        m += 2;
+    }
+
+    // Residues are scaled with the damping so that the peaks of the
+    // response span the conditioning, not the residues themselves.
+    res.residues = Eigen::MatrixXcd::Zero(Nc_, N_);
+    res.D = Eigen::VectorXcd::Zero(Nc_);
+    res.E = Eigen::VectorXcd::Zero(Nc_);
+    for (std::size_t n = 0; n < Nc_; ++n) {
+        for (std::size_t i = 0; i < N_; ++i) {
+            const Complex p = res.poles(i);
+            const Real magnitude = std::pow(conditioning_, -uniform(rng));
+            if (p.imag() == 0.0) {
+                res.residues(n,i) = magnitude * std::abs(p);
+            } else {
+                const Real phase = 2.0 * M_PI * uniform(rng);
+                res.residues(n,i) = std::polar(magnitude * std::abs(p.real()),
+                                               phase);
+                res.residues(n,i+1) = std::conj(res.residues(n,i));
+                ++i;
+            }
+        }
+        if (trend_ != Options::zero) {
+            res.D(n) = 2.0 * uniform(rng) - 1.0;
+        }
+        if (trend_ == Options::linear) {
+            res.E(n) = (2.0 * uniform(rng) - 1.0)
+                     / (2.0 * M_PI * range_.second);
+        }
+    }
+    return res;
+}
+
+std::vector<Real> Generator::getFrequencies() const {
+    return logspace(std::pair<Real, Real>(std::log10(range_.first),
+                                          std::log10(range_.second)), Ns_);
+}
+
+Sample Generator::getSample(const Result& model,
+                            const std::vector<Real>& frequencies,
+                            const std::size_t k) const {
+    const Complex s(0.0, 2.0 * M_PI * frequencies[k]);
+    std::vector<Complex> y(Nc_);
+    for (std::size_t n = 0; n < Nc_; ++n) {
+        y[n] = evaluate(model, n, s);
+    }
+    if (noise_ > 0.0) {
+        std::mt19937_64 rng(mix(seed_, k + 1));
+        std::normal_distribution<Real> normal(0.0, noise_ / std::sqrt(2.0));
+        for (std::size_t n = 0; n < Nc_; ++n) {
+            const Real re = normal(rng);
+            const Real im = normal(rng);
+            y[n] += std::abs(y[n]) * Complex(re, im);
+        }
+    }
+    return Sample(s, y);
+}
+
+std::vector<Sample> Generator::getSamples() const {
+    const Result model = getModel();
+    const std::vector<Real> frequencies = getFrequencies();
+    std::vector<Sample> res(Ns_);
+#pragma omp parallel for schedule(static)
+    for (long k = 0; k < (long) Ns_; ++k) {
+        res[k] = getSample(model, frequencies, k);
+    }
+    return res;
+}
+
+void Generator::write(std::ostream& output) const {
+    Trace::Scope trace("generate", "io");
+    const Result model = getModel();
+    const std::vector<Real> frequencies = getFrequencies();
+    Exporter::writeSamplesHeader(output, Ns_, Nc_);
+    std::vector<Sample> block(std::min(blockSize_, Ns_));
+    for (std::size_t first = 0; first < Ns_; first += blockSize_) {
+        const std::size_t size = std::min(blockSize_, Ns_ - first);
+#pragma omp parallel for schedule(static)
+        for (long k = 0; k < (long) size; ++k) {
+            block[k] = getSample(model, frequencies, first + k);
+        }
+        for (std::size_t k = 0; k < size; ++k) {
+            Exporter::writeSample(output, block[k]);
+        }
+    }
+}
+
+void Generator::write(const std::string& filename) const {
+    std::ofstream file(filename.c_str(), std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open " + filename);
+    }
+    write(file);
+}
+
+Complex Generator::evaluate(const Result& model,
+                            const std::size_t n,
+                            const Complex& s) {
+    Complex res = model.D(n) + s * model.E(n);
+    for (long i = 0; i < model.poles.size(); ++i) {
+        res += model.residues(n,i) / (s - model.poles(i));
+    }
+    return res;
+}
+
+} /* namespace VectorFitting */
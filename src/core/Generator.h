@@ -0,0 +1,109 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEMBA_VECTOR_FITTING_GENERATOR_H_
+#define SEMBA_VECTOR_FITTING_GENERATOR_H_
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "VectorFitting.h"
+
+namespace VectorFitting {
+
+/**
+ * Random stable pole-residue models and their sampled responses, for stress
+ * tests and benchmarks. Everything is a function of the seed and settings
+ * only: the same generator always gives the same model and samples, in any
+ * order and with any number of threads. Samples are log-spaced over the
+ * frequency range.
+ */
+class Generator {
+public:
+    explicit Generator(const std::size_t seed = 0);
+
+    std::size_t getSeed() const {return seed_;}
+    std::size_t getSamplesSize() const {return Ns_;}
+    std::size_t getResponseSize() const {return Nc_;}
+    std::size_t getOrder() const {return N_;}
+    const std::pair<Real, Real>& getFrequencyRange() const {return range_;}
+    Options::AsymptoticTrend getAsymptoticTrend() const {return trend_;}
+    Real getConditioning() const {return conditioning_;}
+    Real getNoise() const {return noise_;}
+    Real getClustering() const {return clustering_;}
+    Real getClusterWidth() const {return clusterWidth_;}
+
+    void setSeed(const std::size_t seed) {seed_ = seed;}
+    void setSamplesSize(const std::size_t Ns);
+    void setResponseSize(const std::size_t Nc);
+    // An odd order gives a single real pole.
+    void setOrder(const std::size_t N);
+    // In Hz, both ends positive.
+    void setFrequencyRange(const std::pair<Real, Real>& range);
+    void setAsymptoticTrend(const Options::AsymptoticTrend trend);
+    // Ratio between the largest and smallest residues of each response.
+    void setConditioning(const Real conditioning);
+    // Standard deviation of the noise relative to each response value.
+    void setNoise(const Real noise);
+    /**
+     * Places a fraction of the poles within a relative bandwidth around a
+     * single random frequency, the rest spread over the whole range.
+     * @param fraction  Of the poles, in [0, 1].
+     * @param width     Relative to the centre frequency, in (0, 1).
+     */
+    void setClustering(const Real fraction, const Real width);
+
+    Result getModel() const;
+    std::vector<Real> getFrequencies() const;  // In Hz.
+
+    // Sample k of Ns, noise included.
+    Sample getSample(const Result& model,
+                     const std::vector<Real>& frequencies,
+                     const std::size_t k) const;
+    std::vector<Sample> getSamples() const;
+
+    /**
+     * Streams the samples in the binary layout of Exporter, a block at a
+     * time, so that the whole set never needs to be in memory.
+     */
+    void write(std::ostream& output) const;
+    void write(const std::string& filename) const;
+
+    static Complex evaluate(const Result& model,
+                            const std::size_t n,
+                            const Complex& s);
+
+private:
+    std::size_t seed_;
+    std::size_t Ns_, Nc_, N_;
+    std::pair<Real, Real> range_;
+    Options::AsymptoticTrend trend_;
+    Real conditioning_;
+    Real noise_;
+    Real clustering_, clusterWidth_;
+
+    static const std::size_t blockSize_ = 4096;
+};
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_GENERATOR_H_ */
@@ -0,0 +1,42 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Hash.h"
+
+#include <cstring>
+
+namespace VectorFitting {
+
+uint64_t hashValues(const Complex* values, const std::size_t size,
+                    uint64_t hash) {
+    for (std::size_t i = 0; i < size; ++i) {
+        const Real parts[2] = {values[i].real(), values[i].imag()};
+        unsigned char bytes[sizeof(parts)];
+        std::memcpy(bytes, parts, sizeof(parts));
+        for (std::size_t b = 0; b < sizeof(bytes); ++b) {
+            hash ^= bytes[b];
+            hash *= 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+} /* namespace VectorFitting */
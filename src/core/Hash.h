@@ -0,0 +1,42 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEMBA_VECTOR_FITTING_HASH_H_
+#define SEMBA_VECTOR_FITTING_HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "VectorFitting.h"
+
+namespace VectorFitting {
+
+const uint64_t hashSeed = 14695981039346656037ULL;
+
+// FNV-1a hash of the bytes of some values, continuing from a previous hash
+// to cover values that are not contiguous. Keys the caches of poles and
+// bases, which then compare the values themselves.
+uint64_t hashValues(const Complex* values, const std::size_t size,
+                    const uint64_t hash = hashSeed);
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_HASH_H_ */
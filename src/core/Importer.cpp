@@ -0,0 +1,341 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Importer.h"
+#include "Exporter.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace VectorFitting {
+
+namespace {
+
+std::size_t readUInt(std::istream& input) {
+    uint64_t v;
+    input.read(reinterpret_cast<char*>(&v), sizeof(v));
+    if (!input) {
+        throw std::runtime_error("Unexpected end of binary data");
+    }
+    return (std::size_t) v;
+}
+
+Real readReal(std::istream& input) {
+    double v;
+    input.read(reinterpret_cast<char*>(&v), sizeof(v));
+    if (!input) {
+        throw std::runtime_error("Unexpected end of binary data");
+    }
+    return (Real) v;
+}
+
+Complex readComplex(std::istream& input) {
+    const Real re = readReal(input);
+    const Real im = readReal(input);
+    return Complex(re, im);
+}
+
+// Bytes left in the input, false for streams that cannot seek.
+bool getRemaining(std::istream& input, std::size_t& remaining) {
+    const std::streampos here = input.tellg();
+    if (here == std::streampos(-1)) {
+        return false;
+    }
+    input.seekg(0, std::ios::end);
+    const std::streampos end = input.tellg();
+    input.clear();
+    input.seekg(here);
+    if (end == std::streampos(-1) || end < here) {
+        return false;
+    }
+    remaining = (std::size_t) (end - here);
+    return true;
+}
+
+void readMagic(std::istream& input, const char magic[8]) {
+    char read[8];
+    input.read(read, sizeof(read));
+    if (!input || std::memcmp(read, magic, sizeof(read)) != 0) {
+        throw std::runtime_error("Unrecognized binary header");
+    }
+}
+
+std::string toLower(std::string str) {
+    std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+    return str;
+}
+
+std::string getExtension(const std::string& filename) {
+    const std::size_t dot = filename.find_last_of('.');
+    if (dot == std::string::npos) {
+        return std::string();
+    }
+    return toLower(filename.substr(dot + 1));
+}
+
+// Number of ports of a Touchstone file, given by its ".sNp" extension.
+std::size_t getTouchstonePorts(const std::string& filename) {
+    const std::string ext = getExtension(filename);
+    if (ext.size() < 3 || ext[0] != 's' || ext[ext.size()-1] != 'p') {
+        return 0;
+    }
+    const std::string digits = ext.substr(1, ext.size() - 2);
+    for (std::size_t i = 0; i < digits.size(); ++i) {
+        if (!std::isdigit(digits[i])) {
+            return 0;
+        }
+    }
+    return (std::size_t) std::atoi(digits.c_str());
+}
+
+} /* namespace */
+
+Importer::Format Importer::guessFormat(const std::string& filename) {
+    const std::string ext = getExtension(filename);
+    if (ext == "txt" || ext == "fdne") {
+        return fdne;
+    }
+    if (ext == "vfs" || ext == "bin") {
+        return binary;
+    }
+    if (getTouchstonePorts(filename) > 0) {
+        return touchstone;
+    }
+    throw std::runtime_error("Unable to guess format of " + filename);
+}
+
+std::vector<Sample> Importer::readSamples(const std::string& filename,
+                                          Format format) {
+    Trace::Scope trace("readSamples", "io");
+    if (format == automatic) {
+        format = guessFormat(filename);
+    }
+    std::ifstream file;
+    if (format == binary) {
+        file.open(filename.c_str(), std::ios::binary);
+    } else {
+        file.open(filename.c_str());
+    }
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open " + filename);
+    }
+    switch (format) {
+    case fdne:
+        return readFdne(file);
+    case touchstone:
+    {
+        const std::size_t nPorts = getTouchstonePorts(filename);
+        if (nPorts == 0) {
+            throw std::runtime_error(
+                    "Touchstone files must have a .sNp extension");
+        }
+        return readTouchstone(file, nPorts);
+    }
+    default:
+        return readBinary(file);
+    }
+}
+
+std::vector<Result> Importer::readModels(const std::string& filename) {
+    Trace::Scope trace("readModels", "io");
+    std::ifstream file(filename.c_str(), std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open " + filename);
+    }
+    readMagic(file, Exporter::modelsMagic);
+    const std::size_t nModels = readUInt(file);
+    std::vector<Result> res(nModels);
+    for (std::size_t i = 0; i < nModels; ++i) {
+        res[i] = readModel(file);
+    }
+    return res;
+}
+
+Result Importer::readModel(std::istream& input) {
+    Result res;
+    res.id = readUInt(input);
+    const std::size_t N  = readUInt(input);
+    const std::size_t Nc = readUInt(input);
+    res.rmse = readReal(input);
+    res.maxDeviation = readReal(input);
+    res.poles.resize(N);
+    for (std::size_t m = 0; m < N; ++m) {
+        res.poles(m) = readComplex(input);
+    }
+    res.residues.resize(Nc, N);
+    for (std::size_t n = 0; n < Nc; ++n) {
+        for (std::size_t m = 0; m < N; ++m) {
+            res.residues(n,m) = readComplex(input);
+        }
+    }
+    res.D.resize(Nc);
+    for (std::size_t n = 0; n < Nc; ++n) {
+        res.D(n) = readComplex(input);
+    }
+    res.E.resize(Nc);
+    for (std::size_t n = 0; n < Nc; ++n) {
+        res.E(n) = readComplex(input);
+    }
+    return res;
+}
+
+std::vector<Sample> Importer::readFdne(std::istream& input) {
+    std::size_t nPorts, Ns;
+    input >> nPorts >> Ns;
+    if (!input || nPorts == 0 || Ns == 0) {
+        throw std::runtime_error("Invalid fdne header");
+    }
+    const std::size_t Nc = nPorts * nPorts;
+    std::vector<Sample> res(Ns, Sample(Complex(0.0,0.0),
+                                       std::vector<Complex>(Nc)));
+    for (std::size_t k = 0; k < Ns; ++k) {
+        Real readS;
+        input >> readS;
+        res[k].first = Complex(0.0, readS);
+        for (std::size_t i = 0; i < Nc; ++i) {
+            Real re, im;
+            input >> re >> im;
+            res[k].second[i] = Complex(re, im);
+        }
+        if (!input) {
+            throw std::runtime_error("Unexpected end of fdne data");
+        }
+    }
+    return res;
+}
+
+std::vector<Sample> Importer::readTouchstone(std::istream& input,
+                                             const std::size_t nPorts) {
+    // Defaults from the Touchstone specification: "# GHz S MA R 50".
+    Real unit = 1e9;
+    std::string format = "ma";
+
+    std::vector<Real> values;
+    std::string line;
+    while (std::getline(input, line)) {
+        const std::size_t comment = line.find('!');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        std::istringstream tokens(line);
+        std::string token;
+        if (!(tokens >> token)) {
+            continue;
+        }
+        if (token[0] == '[') {
+            throw std::runtime_error("Touchstone 2.0 keywords are not supported");
+        }
+        if (token[0] == '#') {
+            std::string option = token.substr(1);
+            do {
+                option = toLower(option);
+                if      (option == "hz" ) unit = 1.0;
+                else if (option == "khz") unit = 1e3;
+                else if (option == "mhz") unit = 1e6;
+                else if (option == "ghz") unit = 1e9;
+                else if (option == "ri" || option == "ma" || option == "db") {
+                    format = option;
+                } else if (option == "r") {
+                    tokens >> option; // Reference impedance.
+                }
+            } while (tokens >> option);
+            continue;
+        }
+        do {
+            values.push_back((Real) std::strtod(token.c_str(), NULL));
+        } while (tokens >> token);
+    }
+
+    const std::size_t Nc = nPorts * nPorts;
+    const std::size_t stride = 1 + 2 * Nc;
+    if (values.empty() || values.size() % stride != 0) {
+        throw std::runtime_error("Touchstone data does not match its ports");
+    }
+    const std::size_t Ns = values.size() / stride;
+    std::vector<Sample> res(Ns, Sample(Complex(0.0,0.0),
+                                       std::vector<Complex>(Nc)));
+    for (std::size_t k = 0; k < Ns; ++k) {
+        const Real* v = &values[k * stride];
+        res[k].first = Complex(0.0, 2.0 * M_PI * v[0] * unit);
+        for (std::size_t i = 0; i < Nc; ++i) {
+            const Real a = v[1 + 2*i];
+            const Real b = v[2 + 2*i];
+            Complex value;
+            if (format == "ri") {
+                value = Complex(a, b);
+            } else if (format == "ma") {
+                value = std::polar(a, b * (Real) M_PI / (Real) 180.0);
+            } else {
+                value = std::polar(std::pow((Real) 10.0, a / (Real) 20.0),
+                                   b * (Real) M_PI / (Real) 180.0);
+            }
+            // Two-port files list N11 N21 N12 N22, the rest go row by row.
+            std::size_t index = i;
+            if (nPorts == 2) {
+                index = (i % 2) * 2 + i / 2;
+            }
+            res[k].second[index] = value;
+        }
+    }
+    return res;
+}
+
+std::vector<Sample> Importer::readBinary(std::istream& input) {
+    readMagic(input, Exporter::samplesMagic);
+    const std::size_t Ns = readUInt(input);
+    const std::size_t Nc = readUInt(input);
+    // A frequency and Nc responses per sample, two doubles each. Sizes are
+    // checked against the input before allocating; when its size cannot be
+    // known, data is only allocated as it is read.
+    const std::size_t complexSize = 2 * sizeof(double);
+    if (Nc >= std::numeric_limits<std::size_t>::max() / complexSize - 1) {
+        throw std::runtime_error("Invalid binary samples size");
+    }
+    std::size_t remaining;
+    const bool known = getRemaining(input, remaining);
+    if (known && Ns > remaining / ((Nc + 1) * complexSize)) {
+        throw std::runtime_error("Unexpected end of binary data");
+    }
+    std::vector<Sample> res;
+    if (known) {
+        res.reserve(Ns);
+    }
+    for (std::size_t k = 0; k < Ns; ++k) {
+        res.push_back(Sample());
+        Sample& sample = res.back();
+        sample.first = readComplex(input);
+        if (known) {
+            sample.second.reserve(Nc);
+        }
+        for (std::size_t i = 0; i < Nc; ++i) {
+            sample.second.push_back(readComplex(input));
+        }
+    }
+    return res;
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,73 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEMBA_VECTOR_FITTING_IMPORTER_H_
+#define SEMBA_VECTOR_FITTING_IMPORTER_H_
+
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "VectorFitting.h"
+
+namespace VectorFitting {
+
+class Importer {
+public:
+    enum Format {
+        automatic,
+        fdne,
+        touchstone,
+        binary
+    };
+
+    /**
+     * Reads the samples stored in a file. Matrix valued data (fdne and
+     * Touchstone) is flattened row by row into Nc*Nc responses.
+     * @param filename  File to be read.
+     * @param format    Format of the file, guessed from the extension when
+     *                  automatic.
+     */
+    static std::vector<Sample> readSamples(const std::string& filename,
+                                           Format format = automatic);
+
+    // Reads a model store written by Exporter::writeModels().
+    static std::vector<Result> readModels(const std::string& filename);
+    static Result readModel(std::istream& input);
+
+    static Format guessFormat(const std::string& filename);
+
+    /**
+     * fdne format: number of ports and of samples, followed by each sample
+     * angular frequency and its matrix as pairs of real and imaginary parts.
+     */
+    static std::vector<Sample> readFdne(std::istream& input);
+
+    // Touchstone 1.x (.sNp); the number of ports must be known beforehand.
+    static std::vector<Sample> readTouchstone(std::istream& input,
+                                              const std::size_t nPorts);
+
+    static std::vector<Sample> readBinary(std::istream& input);
+};
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_IMPORTER_H_ */
@@ -24,12 +24,18 @@
 
 namespace VectorFitting {
 
+const std::size_t Options::reproducibleBlockSize;
+
 Options::Options() {
     relax_                     = true;
     stable_                    = true;
     asymptoticTrend_           = constant;
     skipPoleIdentification_    = false;
     skipResidueIdentification_ = false;
+    solver_                    = householder;
+    reproducible_              = false;
+    basisTolerance_            = 0.0;
+    evaluationTolerance_       = 0.0;
 //    complexSpaceState_         = true;
 }
 
@@ -79,6 +85,38 @@ void Options::setStable(bool stable) {
     stable_ = stable;
 }
 
+Options::Solver Options::getSolver() const {
+    return solver_;
+}
+
+void Options::setSolver(Options::Solver solver) {
+    solver_ = solver;
+}
+
+bool Options::isReproducible() const {
+    return reproducible_;
+}
+
+void Options::setReproducible(bool reproducible) {
+    reproducible_ = reproducible;
+}
+
+Real Options::getBasisTolerance() const {
+    return basisTolerance_;
+}
+
+void Options::setBasisTolerance(Real basisTolerance) {
+    basisTolerance_ = basisTolerance;
+}
+
+Real Options::getEvaluationTolerance() const {
+    return evaluationTolerance_;
+}
+
+void Options::setEvaluationTolerance(Real evaluationTolerance) {
+    evaluationTolerance_ = evaluationTolerance;
+}
+
 //bool VectorFitting::Options::isComplexSpaceState() const {
 //    return complexSpaceState_;
 //}
@@ -23,6 +23,10 @@
 #ifndef SEMBA_VECTOR_FITTING_OPTIONS_H_
 #define SEMBA_VECTOR_FITTING_OPTIONS_H_
 
+#include <cstddef>
+
+#include "Types.h"
+
 namespace VectorFitting {
 
 class Options {
@@ -33,6 +37,16 @@ public:
         linear
     };
 
+    // Reduction of the per response systems in pole identification.
+    enum Solver {
+        householder,        // Householder QR.
+        normalEquations,    // Cholesky of the Gram matrix, cond(A)^2.
+        columnPivoting      // Householder QR, rank revealing final solve.
+    };
+
+    // Responses reduced together, in order, in reproducible mode.
+    static const std::size_t reproducibleBlockSize = 4;
+
     Options();
     virtual ~Options();
 
@@ -42,6 +56,10 @@ public:
     bool isSkipResidueIdentification() const;
     bool isStable() const;
     bool isComplexSpaceState() const;
+    Solver getSolver() const;
+    bool isReproducible() const;
+    Real getBasisTolerance() const;
+    Real getEvaluationTolerance() const;
 
     void setAsymptoticTrend(AsymptoticTrend asymptoticTrend);
     void setRelax(bool relax);
@@ -49,6 +67,21 @@ public:
     void setSkipResidueIdentification(bool skipResidueIdentification);
     void setStable(bool stable);
     void setComplexSpaceState(bool complexSpaceState);
+    void setSolver(Solver solver);
+    // Results bitwise identical for any number of threads, on the same host
+    // and build. The responses are reduced in fixed blocks of
+    // reproducibleBlockSize and then along a fixed binary tree, and Eigen's
+    // own products run on one thread, as their blocking depends on the
+    // number of threads. It costs one (N+1)x(N+1) factor per block and a few
+    // barriers, usually a few percent of fit().
+    void setReproducible(bool reproducible);
+    // Poles that moved less than this, relative to their magnitude, since
+    // the previous call to fit() keep their previous value and basis
+    // columns. Zero, the default, only keeps poles that did not move.
+    void setBasisTolerance(Real basisTolerance);
+    // Relative error allowed to the products with the basis when the model
+    // is evaluated, see Cauchy. Zero, the default, evaluates it densely.
+    void setEvaluationTolerance(Real evaluationTolerance);
 
 private:
     bool relax_;
@@ -56,6 +89,10 @@ private:
     AsymptoticTrend asymptoticTrend_;
     bool skipPoleIdentification_;
     bool skipResidueIdentification_;
+    Solver solver_;
+    bool reproducible_;
+    Real basisTolerance_;
+    Real evaluationTolerance_;
 //    bool complexSpaceState_;
 };
 
@@ -0,0 +1,147 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "PoleCache.h"
+#include "Hash.h"
+#include "SampleSet.h"
+
+#include <stdexcept>
+
+namespace VectorFitting {
+
+bool PoleCache::Key::operator<(const Key& rhs) const {
+    if (grid  != rhs.grid ) return grid  < rhs.grid;
+    if (Ns    != rhs.Ns   ) return Ns    < rhs.Ns;
+    if (Nc    != rhs.Nc   ) return Nc    < rhs.Nc;
+    if (order != rhs.order) return order < rhs.order;
+    return trend < rhs.trend;
+}
+
+PoleCache::PoleCache(const std::size_t capacity) {
+    if (capacity == 0) {
+        throw std::runtime_error("Pole cache capacity cannot be zero");
+    }
+    capacity_ = capacity;
+    clock_ = 0;
+}
+
+PoleCache::~PoleCache() {
+}
+
+bool PoleCache::get(const std::vector<Sample>& samples,
+                    const std::size_t order,
+                    const Options::AsymptoticTrend trend,
+                    std::vector<Complex>& poles) const {
+    return get(buildKey(samples, order, trend), poles);
+}
+
+void PoleCache::set(const std::vector<Sample>& samples,
+                    const std::size_t order,
+                    const Options::AsymptoticTrend trend,
+                    const std::vector<Complex>& poles) {
+    set(buildKey(samples, order, trend), poles);
+}
+
+bool PoleCache::get(const SampleSet& data,
+                    const std::size_t order,
+                    const Options::AsymptoticTrend trend,
+                    std::vector<Complex>& poles) const {
+    return get(buildKey(data, order, trend), poles);
+}
+
+void PoleCache::set(const SampleSet& data,
+                    const std::size_t order,
+                    const Options::AsymptoticTrend trend,
+                    const std::vector<Complex>& poles) {
+    set(buildKey(data, order, trend), poles);
+}
+
+bool PoleCache::get(const Key& key, std::vector<Complex>& poles) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<Key, Entry>::iterator it = entries_.find(key);
+    if (it == entries_.end()) {
+        return false;
+    }
+    it->second.lastUse = ++clock_;
+    poles = it->second.poles;
+    return true;
+}
+
+void PoleCache::set(const Key& key, const std::vector<Complex>& poles) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.size() >= capacity_ && entries_.count(key) == 0) {
+        std::map<Key, Entry>::iterator oldest = entries_.begin();
+        for (std::map<Key, Entry>::iterator it = entries_.begin();
+                it != entries_.end(); ++it) {
+            if (it->second.lastUse < oldest->second.lastUse) {
+                oldest = it;
+            }
+        }
+        entries_.erase(oldest);
+    }
+    Entry& entry = entries_[key];
+    entry.poles = poles;
+    entry.lastUse = ++clock_;
+}
+
+std::size_t PoleCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+void PoleCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+}
+
+uint64_t PoleCache::hashGrid(const std::vector<Sample>& samples) {
+    uint64_t hash = hashSeed;
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        hash = hashValues(&samples[i].first, 1, hash);
+    }
+    return hash;
+}
+
+PoleCache::Key PoleCache::buildKey(const std::vector<Sample>& samples,
+                                   const std::size_t order,
+                                   const Options::AsymptoticTrend trend) {
+    Key key;
+    key.grid  = hashGrid(samples);
+    key.Ns    = samples.size();
+    key.Nc    = samples.empty() ? 0 : samples.front().second.size();
+    key.order = order;
+    key.trend = (int) trend;
+    return key;
+}
+
+PoleCache::Key PoleCache::buildKey(const SampleSet& data,
+                                   const std::size_t order,
+                                   const Options::AsymptoticTrend trend) {
+    Key key;
+    key.grid  = data.getGridHash();
+    key.Ns    = data.getSamplesSize();
+    key.Nc    = data.getResponseSize();
+    key.order = order;
+    key.trend = (int) trend;
+    return key;
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,98 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEMBA_VECTOR_FITTING_POLECACHE_H_
+#define SEMBA_VECTOR_FITTING_POLECACHE_H_
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "VectorFitting.h"
+
+namespace VectorFitting {
+
+/**
+ * Thread-safe store of converged poles, used to warm-start later fits of
+ * data sampled on the same grid with the same number of responses, order and
+ * asymptotic trend. When full, the least recently used entry is dropped.
+ */
+class PoleCache {
+public:
+    explicit PoleCache(const std::size_t capacity = 1024);
+    virtual ~PoleCache();
+
+    bool get(const std::vector<Sample>& samples,
+             const std::size_t order,
+             const Options::AsymptoticTrend trend,
+             std::vector<Complex>& poles) const;
+    void set(const std::vector<Sample>& samples,
+             const std::size_t order,
+             const Options::AsymptoticTrend trend,
+             const std::vector<Complex>& poles);
+    // Same, with the cached grid hash of the set.
+    bool get(const SampleSet& data,
+             const std::size_t order,
+             const Options::AsymptoticTrend trend,
+             std::vector<Complex>& poles) const;
+    void set(const SampleSet& data,
+             const std::size_t order,
+             const Options::AsymptoticTrend trend,
+             const std::vector<Complex>& poles);
+
+    std::size_t size() const;
+    void clear();
+
+    // FNV-1a hash of the sampled frequencies.
+    static uint64_t hashGrid(const std::vector<Sample>& samples);
+
+private:
+    struct Key {
+        uint64_t grid;
+        std::size_t Ns, Nc, order;
+        int trend;
+
+        bool operator<(const Key& rhs) const;
+    };
+    struct Entry {
+        std::vector<Complex> poles;
+        uint64_t lastUse;
+    };
+
+    std::size_t capacity_;
+    mutable std::mutex mutex_;
+    mutable uint64_t clock_;
+    mutable std::map<Key, Entry> entries_;
+
+    static Key buildKey(const std::vector<Sample>& samples,
+                        const std::size_t order,
+                        const Options::AsymptoticTrend trend);
+    static Key buildKey(const SampleSet& data,
+                        const std::size_t order,
+                        const Options::AsymptoticTrend trend);
+
+    bool get(const Key& key, std::vector<Complex>& poles) const;
+    void set(const Key& key, const std::vector<Complex>& poles);
+};
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_POLECACHE_H_ */
@@ -0,0 +1,174 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Protocol.h"
+#include "Exporter.h"
+#include "Importer.h"
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace VectorFitting {
+
+const char Protocol::requestMagic[8]  = {'V','F','R','Q','0','0','0','1'};
+const char Protocol::responseMagic[8] = {'V','F','R','S','0','0','0','1'};
+const std::size_t Protocol::requestHeaderSize =
+        sizeof(requestMagic) + 7 * sizeof(uint64_t) + sizeof(double) +
+        sizeof(Exporter::samplesMagic) + 2 * sizeof(uint64_t);
+
+namespace {
+
+void writeUInt(std::ostream& output, const std::size_t value) {
+    const uint64_t v = value;
+    output.write(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+std::size_t readUInt(std::istream& input) {
+    uint64_t v;
+    input.read(reinterpret_cast<char*>(&v), sizeof(v));
+    if (!input) {
+        throw std::runtime_error("Truncated message");
+    }
+    return (std::size_t) v;
+}
+
+void checkMagic(std::istream& input, const char magic[8]) {
+    char read[8];
+    input.read(read, sizeof(read));
+    if (!input || std::memcmp(read, magic, sizeof(read)) != 0) {
+        throw std::runtime_error("Unrecognized message");
+    }
+}
+
+} /* namespace */
+
+Protocol::Request::Request() {
+    id         = 0;
+    minOrder   = 10;
+    maxOrder   = 10;
+    orderStep  = 2;
+    iterations = 5;
+    targetRMSE = 0.0;
+    trend      = Options::constant;
+    weighting  = BatchFitter::uniform;
+}
+
+Protocol::Response::Response() {
+    id = 0;
+    ok = false;
+}
+
+std::string Protocol::encode(const Request& request) {
+    std::ostringstream output(std::ios::binary);
+    output.write(requestMagic, sizeof(requestMagic));
+    writeUInt(output, request.id);
+    writeUInt(output, request.minOrder);
+    writeUInt(output, request.maxOrder);
+    writeUInt(output, request.orderStep);
+    writeUInt(output, request.iterations);
+    const double target = request.targetRMSE;
+    output.write(reinterpret_cast<const char*>(&target), sizeof(target));
+    writeUInt(output, (std::size_t) request.trend);
+    writeUInt(output, (std::size_t) request.weighting);
+    const std::size_t Nc = request.samples.empty() ?
+            0 : request.samples.front().second.size();
+    Exporter::writeSamplesHeader(output, request.samples.size(), Nc);
+    for (std::size_t i = 0; i < request.samples.size(); ++i) {
+        Exporter::writeSample(output, request.samples[i]);
+    }
+    return output.str();
+}
+
+std::string Protocol::encode(const Response& response) {
+    std::ostringstream output(std::ios::binary);
+    output.write(responseMagic, sizeof(responseMagic));
+    writeUInt(output, response.id);
+    writeUInt(output, response.ok ? 1 : 0);
+    if (response.ok) {
+        Exporter::writeModel(output, response.model);
+    } else {
+        writeUInt(output, response.error.size());
+        output.write(response.error.data(), response.error.size());
+    }
+    return output.str();
+}
+
+Protocol::Request Protocol::decodeRequest(const std::string& payload) {
+    std::istringstream input(payload, std::ios::binary);
+    checkMagic(input, requestMagic);
+    Request res;
+    res.id         = readUInt(input);
+    res.minOrder   = readUInt(input);
+    res.maxOrder   = readUInt(input);
+    res.orderStep  = readUInt(input);
+    res.iterations = readUInt(input);
+    double target;
+    input.read(reinterpret_cast<char*>(&target), sizeof(target));
+    if (!input) {
+        throw std::runtime_error("Truncated message");
+    }
+    res.targetRMSE = (Real) target;
+    const std::size_t trend = readUInt(input);
+    if (trend > (std::size_t) Options::linear) {
+        throw std::runtime_error("Unknown asymptotic trend");
+    }
+    res.trend = (Options::AsymptoticTrend) trend;
+    const std::size_t weighting = readUInt(input);
+    if (weighting > (std::size_t) BatchFitter::inverseMagnitude) {
+        throw std::runtime_error("Unknown weighting");
+    }
+    res.weighting = (BatchFitter::Weighting) weighting;
+    res.samples = Importer::readBinary(input);
+    return res;
+}
+
+Protocol::Response Protocol::decodeResponse(const std::string& payload) {
+    std::istringstream input(payload, std::ios::binary);
+    checkMagic(input, responseMagic);
+    Response res;
+    res.id = readUInt(input);
+    res.ok = readUInt(input) != 0;
+    if (res.ok) {
+        res.model = Importer::readModel(input);
+    } else {
+        const std::size_t size = readUInt(input);
+        if (size > payload.size() - (std::size_t) input.tellg()) {
+            throw std::runtime_error("Truncated message");
+        }
+        res.error.resize(size);
+        input.read(&res.error[0], size);
+    }
+    return res;
+}
+
+BatchFitter Protocol::getFitter(const Request& request) {
+    Options opts;
+    opts.setAsymptoticTrend(request.trend);
+    BatchFitter res(opts);
+    res.setOrders(request.minOrder, request.maxOrder, request.orderStep);
+    res.setIterations(request.iterations);
+    res.setTargetRMSE(request.targetRMSE);
+    res.setWeighting(request.weighting);
+    return res;
+}
+
+} /* namespace VectorFitting */
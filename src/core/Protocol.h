@@ -0,0 +1,77 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEMBA_VECTOR_FITTING_PROTOCOL_H_
+#define SEMBA_VECTOR_FITTING_PROTOCOL_H_
+
+#include <string>
+#include <vector>
+
+#include "BatchFitter.h"
+
+namespace VectorFitting {
+
+/**
+ * Messages exchanged with the fitting daemon. On the wire every message is
+ * a frame: its payload size as a 64 bit integer followed by the payload.
+ * Request payloads carry the fitting settings and the samples in the binary
+ * samples layout; responses carry either a binary model record or an error.
+ */
+class Protocol {
+public:
+    struct Request {
+        std::size_t id;
+        std::size_t minOrder, maxOrder, orderStep;
+        std::size_t iterations;
+        Real targetRMSE;
+        Options::AsymptoticTrend trend;
+        BatchFitter::Weighting weighting;
+        std::vector<Sample> samples;
+
+        Request();
+    };
+
+    struct Response {
+        std::size_t id;
+        bool ok;
+        std::string error;
+        Result model;
+
+        Response();
+    };
+
+    static const char requestMagic[8];
+    static const char responseMagic[8];
+    // Smallest request payload, settings and an empty samples header.
+    static const std::size_t requestHeaderSize;
+
+    static std::string encode(const Request& request);
+    static std::string encode(const Response& response);
+    static Request  decodeRequest (const std::string& payload);
+    static Response decodeResponse(const std::string& payload);
+
+    // Builds a fitter configured as asked by the request.
+    static BatchFitter getFitter(const Request& request);
+};
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_PROTOCOL_H_ */
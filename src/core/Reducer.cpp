@@ -0,0 +1,50 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Reducer.h"
+
+namespace VectorFitting {
+
+using namespace Eigen;
+
+void Reducer::merge(MatrixXd& R, VectorXd& b,
+                    const MatrixXd& Rn, const VectorXd& bn) {
+    if (Rn.rows() == 0) {
+        return;
+    }
+    if (R.rows() == 0) {
+        R = Rn;
+        b = bn;
+        return;
+    }
+    const Index M = R.cols();
+    MatrixXd stacked(R.rows() + Rn.rows(), M);
+    stacked << R, Rn;
+    VectorXd rhs(b.size() + bn.size());
+    rhs << b, bn;
+
+    HouseholderQR<MatrixXd> qr(stacked);
+    R = qr.matrixQR().topRows(M).triangularView<Upper>();
+    rhs.applyOnTheLeft(qr.householderQ().transpose());
+    b = rhs.head(M);
+}
+
+} /* namespace VectorFitting */
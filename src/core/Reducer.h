@@ -0,0 +1,69 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEMBA_VECTOR_FITTING_REDUCER_H_
+#define SEMBA_VECTOR_FITTING_REDUCER_H_
+
+#include <cstddef>
+#include <utility>
+#include <eigen3/Eigen/Dense>
+
+namespace VectorFitting {
+
+/**
+ * Splits the responses of a single fit among several participants (e.g. MPI
+ * ranks), each one holding all the samples. Every participant identifies
+ * poles only with its own responses and the reducer combines the resulting
+ * triangular factors (TSQR); residues are identified locally and gathered.
+ */
+class Reducer {
+public:
+    virtual ~Reducer() {}
+
+    // Responses [first, last) handled by this participant out of Nc.
+    virtual std::pair<std::size_t, std::size_t> getResponseRange(
+            const std::size_t Nc) const = 0;
+
+    /**
+     * Combines the local triangular factor R and projected right hand side
+     * b with those of the other participants. On return all participants
+     * hold the global ones.
+     */
+    virtual void reduce(Eigen::MatrixXd& R, Eigen::VectorXd& b) = 0;
+
+    // Completes the rows of C and the entries of D and E that were
+    // computed by the other participants.
+    virtual void gather(Eigen::MatrixXcd& C,
+                        Eigen::VectorXcd& D,
+                        Eigen::VectorXcd& E) = 0;
+
+    /**
+     * TSQR step: replaces (R, b) by the triangular factor and projected
+     * right hand side of the stacked system [R; Rn] x = [b; bn]. An empty
+     * R (no rows) is taken as the neutral element.
+     */
+    static void merge(Eigen::MatrixXd& R, Eigen::VectorXd& b,
+                      const Eigen::MatrixXd& Rn, const Eigen::VectorXd& bn);
+};
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_REDUCER_H_ */
@@ -0,0 +1,62 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEMBA_VECTOR_FITTING_RESULT_H_
+#define SEMBA_VECTOR_FITTING_RESULT_H_
+
+#include <complex>
+#include <cstddef>
+#include <eigen3/Eigen/Dense>
+
+#include "Types.h"
+#include "Channel.h"
+#include "Statistics.h"
+
+namespace VectorFitting {
+
+/**
+ * Compact pole-residue model produced by a fit, together with its quality
+ * metrics. It owns its buffers and is meant to be moved, not copied, when
+ * handed over to a consumer.
+ */
+struct Result {
+    std::size_t id;
+
+    Eigen::VectorXcd poles;     // Size:  N.
+    Eigen::MatrixXcd residues;  // Size: Nc, N.
+    Eigen::VectorXcd D;         // Size: Nc.
+    Eigen::VectorXcd E;         // Size: Nc.
+
+    Real rmse;
+    Real maxDeviation;
+
+    // Cost of producing this model. BatchFitter accounts for every fit it
+    // tried, discarded ones included.
+    Statistics statistics;
+
+    Result() : id(0), rmse(0.0), maxDeviation(0.0) {}
+};
+
+typedef Channel<Result> ResultChannel;
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_RESULT_H_ */
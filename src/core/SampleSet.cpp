@@ -0,0 +1,119 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "SampleSet.h"
+#include "Hash.h"
+#include "Tuning.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace VectorFitting {
+
+SampleSet::SampleSet(const std::vector<Sample>& samples,
+                     const std::vector<std::vector<Real>>& weights,
+                     const std::size_t threads) {
+    if (samples.size() == 0) {
+        throw std::runtime_error("Samples size cannot be zero");
+    }
+    if (weights.size() != 0 && weights.size() != samples.size()) {
+        throw std::runtime_error("Weights and samples must have same size.");
+    }
+    const std::size_t Ns = samples.size();
+    const std::size_t Nc = samples.front().second.size();
+    for (std::size_t i = 0; i < weights.size(); ++i) {
+        if (weights[i].size() != Nc) {
+            throw std::runtime_error(
+                    "All weights must have the same size as the samples");
+        }
+    }
+    for (std::size_t i = 0; i < Ns; ++i) {
+        if (samples[i].second.size() != Nc) {
+            throw std::runtime_error(
+                    "All samples must have the same number of responses");
+        }
+    }
+
+    frequencies_.resize(Ns);
+    for (std::size_t i = 0; i < Ns; ++i) {
+        frequencies_(i) = samples[i].first;
+    }
+    // Blocks of responses as fit() deals them to its threads, so that each
+    // block is first touched, and its pages placed, by the thread that will
+    // read it when the team is bound.
+    weights_.resize(Ns, Nc);
+    responses_.resize(Ns, Nc);
+    const int team = Tuning::getThreads(threads);
+    const long chunk = std::max<long>(1, ((long) Nc + team - 1) / team);
+#pragma omp parallel for if (team > 1) num_threads(team) \
+                         schedule(static, chunk)
+    for (long jj = 0; jj < (long) Nc; ++jj) {
+        const std::size_t j = (std::size_t) jj;
+        for (std::size_t i = 0; i < Ns; ++i) {
+            weights_(i,j) = weights.empty() ? 1.0 : weights[i][j];
+            responses_(i,j) = samples[i].second[j];
+        }
+    }
+
+    range_.first  = samples.front().first.imag();
+    range_.second = samples.front().first.imag();
+    for (std::size_t i = 1; i < Ns; ++i) {
+        range_.first  = std::min(range_.first,  samples[i].first.imag());
+        range_.second = std::max(range_.second, samples[i].first.imag());
+    }
+
+    // Same order as fit() has always summed it, results do not change.
+    Real sum = 0.0;
+    for (std::size_t m = 0; m < Nc; ++m) {
+        for (std::size_t i = 0; i < Ns; ++i) {
+            const Real weight = weights_(i,m);
+            const Complex sample = responses_(i,m);
+            sum += std::pow(std::abs(weight * std::conj(sample)), 2);
+        }
+    }
+    weightedNorm_ = std::sqrt(sum);
+
+    // Same as PoleCache::hashGrid() of the samples.
+    gridHash_ = hashValues(frequencies_.data(), Ns);
+}
+
+std::vector<Sample> SampleSet::getSamples() const {
+    const std::size_t Nc = getResponseSize();
+    std::vector<Sample> res(getSamplesSize());
+    for (std::size_t i = 0; i < res.size(); ++i) {
+        res[i].first = frequencies_(i);
+        res[i].second.resize(Nc);
+        for (std::size_t j = 0; j < Nc; ++j) {
+            res[i].second[j] = responses_(i,j);
+        }
+    }
+    return res;
+}
+
+std::shared_ptr<const SampleSet> SampleSet::build(
+        const std::vector<Sample>& samples,
+        const std::vector<std::vector<Real>>& weights,
+        const std::size_t threads) {
+    return std::make_shared<const SampleSet>(samples, weights, threads);
+}
+
+} /* namespace VectorFitting */
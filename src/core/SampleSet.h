@@ -0,0 +1,96 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SEMBA_VECTOR_FITTING_SAMPLESET_H_
+#define SEMBA_VECTOR_FITTING_SAMPLESET_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "VectorFitting.h"
+
+namespace VectorFitting {
+
+/**
+ * Samples and weights of a fit, together with the quantities that depend
+ * only on them, computed once on construction. It is immutable, so any
+ * number of fitters, on any threads, can share one through a shared_ptr
+ * without copies or locks.
+ */
+class SampleSet {
+public:
+    /**
+     * @param samples   Data to be fitted, cannot be empty.
+     * @param weights   Ns vectors of Nc weights, or empty for uniform ones.
+     * @param threads   Copying the data, zero for the OpenMP default. With
+     *                  the threads of the fits bound to cores (OMP_PLACES
+     *                  and OMP_PROC_BIND) and as many of them, each one
+     *                  reads responses placed on its own NUMA node.
+     */
+    SampleSet(const std::vector<Sample>& samples,
+              const std::vector<std::vector<Real>>& weights =
+                      std::vector<std::vector<Real>>(),
+              const std::size_t threads = 1);
+
+    // Same arguments as the constructor.
+    static std::shared_ptr<const SampleSet> build(
+            const std::vector<Sample>& samples,
+            const std::vector<std::vector<Real>>& weights =
+                    std::vector<std::vector<Real>>(),
+            const std::size_t threads = 1);
+
+    // The data as given, assembled from the frequencies and responses on
+    // each call.
+    std::vector<Sample> getSamples() const;
+    const MatrixXd& getWeights() const {return weights_;} // Size: Ns, Nc.
+    // Frequency of each sample. Size: Ns.
+    const VectorXcd& getFrequencies() const {return frequencies_;}
+    // Contiguous copy of the data, each response a column. Size: Ns, Nc.
+    const MatrixXcd& getResponses() const {return responses_;}
+    std::size_t getSamplesSize() const {return frequencies_.size();}
+    std::size_t getResponseSize() const {return weights_.cols();}
+
+    // Lowest and highest imaginary parts of the frequencies.
+    const std::pair<Real, Real>& getFrequencyRange() const {return range_;}
+    // Frobenius norm of the weighted data.
+    Real getWeightedNorm() const {return weightedNorm_;}
+    // Of the integral criterion row in pole identification.
+    Real getScale() const {
+        return weightedNorm_ / (Real) frequencies_.size();
+    }
+    // See PoleCache::hashGrid().
+    uint64_t getGridHash() const {return gridHash_;}
+
+private:
+    VectorXcd frequencies_;
+    MatrixXd weights_;
+    MatrixXcd responses_;
+    std::pair<Real, Real> range_;
+    Real weightedNorm_;
+    uint64_t gridHash_;
+};
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_SAMPLESET_H_ */
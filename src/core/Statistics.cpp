@@ -0,0 +1,153 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Statistics.h"
+
+#include <algorithm>
+
+namespace VectorFitting {
+
+Health::Health() {
+    valid            = false;
+    solver           = Options::householder;
+    basisCondition   = 0.0;
+    systemCondition  = 0.0;
+    reducedCondition = 0.0;
+    escaleSpread     = 0.0;
+    poleMovement     = 0.0;
+    sigmaD           = 0.0;
+    fallbacks        = 0;
+    reusedColumns    = 0;
+}
+
+Statistics::Statistics() {
+    for (std::size_t p = 0; p < numberOfPhases; ++p) {
+        seconds[p] = 0.0;
+        calls[p]   = 0;
+        flops[p]   = 0.0;
+        allocations[p]    = 0;
+        allocatedBytes[p] = 0;
+        peakBytes[p]      = 0;
+        for (std::size_t e = 0; e < Counters::numberOfEvents; ++e) {
+            counters[p][e] = 0;
+        }
+    }
+    iterations = 0;
+}
+
+Real Statistics::getSeconds() const {
+    Real res = 0.0;
+    for (std::size_t p = 0; p < numberOfPhases; ++p) {
+        res += seconds[p];
+    }
+    return res;
+}
+
+Real Statistics::getFlops() const {
+    Real res = 0.0;
+    for (std::size_t p = 0; p < numberOfPhases; ++p) {
+        res += flops[p];
+    }
+    return res;
+}
+
+std::size_t Statistics::getAllocations() const {
+    std::size_t res = 0;
+    for (std::size_t p = 0; p < numberOfPhases; ++p) {
+        res += allocations[p];
+    }
+    return res;
+}
+
+std::size_t Statistics::getAllocatedBytes() const {
+    std::size_t res = 0;
+    for (std::size_t p = 0; p < numberOfPhases; ++p) {
+        res += allocatedBytes[p];
+    }
+    return res;
+}
+
+std::size_t Statistics::getPeakBytes() const {
+    std::size_t res = 0;
+    for (std::size_t p = 0; p < numberOfPhases; ++p) {
+        res = std::max(res, peakBytes[p]);
+    }
+    return res;
+}
+
+Real Statistics::getIPC(const Phase phase) const {
+    const std::uint64_t cycles = counters[phase][Counters::cycles];
+    if (cycles == 0) {
+        return 0.0;
+    }
+    return (Real) counters[phase][Counters::instructions] / (Real) cycles;
+}
+
+Real Statistics::getCacheMissRate(const Phase phase) const {
+    const std::uint64_t references =
+            counters[phase][Counters::cacheReferences];
+    if (references == 0) {
+        return 0.0;
+    }
+    return (Real) counters[phase][Counters::cacheMisses] / (Real) references;
+}
+
+Statistics& Statistics::operator+=(const Statistics& rhs) {
+    for (std::size_t p = 0; p < numberOfPhases; ++p) {
+        seconds[p] += rhs.seconds[p];
+        calls[p]   += rhs.calls[p];
+        flops[p]   += rhs.flops[p];
+        allocations[p]    += rhs.allocations[p];
+        allocatedBytes[p] += rhs.allocatedBytes[p];
+        peakBytes[p] = std::max(peakBytes[p], rhs.peakBytes[p]);
+        for (std::size_t e = 0; e < Counters::numberOfEvents; ++e) {
+            counters[p][e] += rhs.counters[p][e];
+        }
+    }
+    iterations += rhs.iterations;
+    if (rhs.health.valid) {
+        health = rhs.health;
+    }
+    return *this;
+}
+
+const char* Statistics::getName(const Phase phase) {
+    switch (phase) {
+    case basis:
+        return "basis";
+    case assembly:
+        return "assembly";
+    case solve:
+        return "solve";
+    case eigen:
+        return "eigen";
+    case sorting:
+        return "sorting";
+    case residues:
+        return "residues";
+    case error:
+        return "error";
+    default:
+        return "unknown";
+    }
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,200 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEMBA_VECTOR_FITTING_STATISTICS_H_
+#define SEMBA_VECTOR_FITTING_STATISTICS_H_
+
+#include <cstddef>
+
+#include "Allocation.h"
+#include "Counters.h"
+#include "Options.h"
+#include "Trace.h"
+#include "Types.h"
+
+namespace VectorFitting {
+
+/**
+ * Cheap indicators of the numerical state of a pole identification, taken
+ * from quantities fit() computes anyway. Conditions are estimated as the
+ * ratio of the extreme diagonal entries of triangular factors.
+ */
+struct Health {
+    bool valid;                 // False until pole identification ran.
+    Options::Solver solver;     // Used for the per response systems.
+    Real basisCondition;        // Worst weighted Dk, leading block of the
+                                // per response factors.
+    Real systemCondition;       // Worst per response system.
+    Real reducedCondition;      // Column scaled reduced system.
+    Real escaleSpread;          // Largest over smallest column scaling.
+    Real poleMovement;          // Largest relative displacement of a pole.
+    Real sigmaD;                // |D| of sigma, fit() fails when tiny.
+    std::size_t fallbacks;      // Systems redone with Householder QR.
+    std::size_t reusedColumns;  // Basis columns kept from the last call.
+
+    Health();
+};
+
+/**
+ * Time, calls and estimated flops spent in each phase of a fit, the heap it
+ * used when built with CompileWithAllocationTracking (see Allocation for
+ * concurrent fits) and, while Counters are enabled, the hardware events of
+ * the calling thread. Defining CompileWithoutStatistics leaves everything
+ * at zero. Phases are also recorded as Trace events, the Stopwatch is a
+ * no-op only when both are compiled out.
+ */
+struct Statistics {
+    enum Phase {
+        basis,      // Dk construction.
+        assembly,   // Per response systems, their QR and reduction.
+        solve,      // Solution of the reduced system for sigma.
+        eigen,      // Zeros of sigma.
+        sorting,    // Ordering of the new poles.
+        residues,   // Residue identification systems and solves.
+        error,      // Evaluation of the fitted samples and metrics.
+        numberOfPhases
+    };
+
+    Real seconds[numberOfPhases];
+    std::size_t calls[numberOfPhases];
+    Real flops[numberOfPhases];
+    std::size_t allocations[numberOfPhases];
+    std::size_t allocatedBytes[numberOfPhases];
+    // High-water mark of the heap, over its usage when fit() was called.
+    std::size_t peakBytes[numberOfPhases];
+    std::uint64_t counters[numberOfPhases][Counters::numberOfEvents];
+    std::size_t iterations;     // Calls to fit().
+    Health health;              // Of the last call to fit().
+
+    Statistics();
+
+    Real getSeconds() const;
+    Real getFlops() const;
+    std::size_t getAllocations() const;
+    std::size_t getAllocatedBytes() const;
+    std::size_t getPeakBytes() const;
+    // Instructions per cycle and last level cache misses per reference of
+    // a phase, zero when not counted.
+    Real getIPC(const Phase phase) const;
+    Real getCacheMissRate(const Phase phase) const;
+
+    Statistics& operator+=(const Statistics& rhs);
+
+    static const char* getName(const Phase phase);
+
+    // Charges the time elapsed between start() and stop() to a phase.
+    class Stopwatch {
+    public:
+        Stopwatch(Statistics& statistics);
+        ~Stopwatch();
+
+        // Stops the running phase, if any, and starts this one.
+        void start(const Phase phase, const std::size_t calls = 1);
+        void stop();
+
+    private:
+#if !defined(CompileWithoutStatistics) || !defined(CompileWithoutTracing)
+        Statistics& statistics_;
+        Phase phase_;
+        bool running_;
+        std::uint64_t start_;
+#ifndef CompileWithoutStatistics
+        std::size_t baseline_, allocations_, allocatedBytes_;
+        Allocation::Peak peak_;
+        bool counting_;
+        std::uint64_t counters_[Counters::numberOfEvents];
+#endif
+#endif
+    };
+};
+
+#if defined(CompileWithoutStatistics) && defined(CompileWithoutTracing)
+inline Statistics::Stopwatch::Stopwatch(Statistics&) {}
+inline Statistics::Stopwatch::~Stopwatch() {}
+inline void Statistics::Stopwatch::start(const Phase, const std::size_t) {}
+inline void Statistics::Stopwatch::stop() {}
+#else
+inline Statistics::Stopwatch::Stopwatch(Statistics& statistics)
+:   statistics_(statistics), phase_(basis), running_(false), start_(0) {
+#ifndef CompileWithoutStatistics
+    baseline_ = Allocation::getCurrent();
+    allocations_ = allocatedBytes_ = 0;
+    counting_ = false;
+#endif
+}
+
+inline Statistics::Stopwatch::~Stopwatch() {
+    stop();
+}
+
+inline void Statistics::Stopwatch::start(const Phase phase,
+                                         const std::size_t calls) {
+    stop();
+    phase_ = phase;
+    running_ = true;
+#ifndef CompileWithoutStatistics
+    statistics_.calls[phase] += calls;
+    peak_.reset();
+    allocations_    = Allocation::getCount();
+    allocatedBytes_ = Allocation::getBytes();
+    counting_ = Counters::isEnabled();
+    if (counting_) {
+        Counters::read(counters_);
+    }
+#else
+    (void) calls;
+#endif
+    start_ = Trace::now();
+}
+
+inline void Statistics::Stopwatch::stop() {
+    if (running_) {
+        const std::uint64_t end = Trace::now();
+#ifndef CompileWithoutStatistics
+        statistics_.seconds[phase_] += (Real) (end - start_) * 1e-9;
+        statistics_.allocations[phase_] +=
+                Allocation::getCount() - allocations_;
+        statistics_.allocatedBytes[phase_] +=
+                Allocation::getBytes() - allocatedBytes_;
+        const std::size_t peak = peak_.get();
+        std::size_t& highest = statistics_.peakBytes[phase_];
+        if (peak > baseline_ && peak - baseline_ > highest) {
+            highest = peak - baseline_;
+        }
+        if (counting_) {
+            std::uint64_t counters[Counters::numberOfEvents];
+            Counters::read(counters);
+            for (int e = 0; e < Counters::numberOfEvents; ++e) {
+                statistics_.counters[phase_][e] += counters[e] - counters_[e];
+            }
+        }
+#endif
+        if (Trace::isEnabled()) {
+            Trace::record(getName(phase_), "fit", start_, end);
+        }
+        running_ = false;
+    }
+}
+#endif
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_STATISTICS_H_ */
@@ -0,0 +1,215 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#include "Trace.h"
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace VectorFitting {
+
+#ifndef CompileWithoutTracing
+namespace {
+
+struct Event {
+    const char* name;
+    const char* category;
+    std::uint64_t begin, end;
+    std::size_t id;
+};
+
+// Events are never moved once written, so write() can read them while
+// their thread keeps appending to later positions.
+struct Chunk {
+    static const std::size_t capacity = 4096;
+    Event events[capacity];
+    std::atomic<std::size_t> size;
+    std::atomic<Chunk*> next;
+    Chunk() : size(0), next(NULL) {}
+};
+
+struct Buffer {
+    std::size_t tid;
+    Chunk* first;
+    Chunk* last;    // Only touched by the owner thread.
+};
+
+std::atomic<bool> enabled(false);
+
+// Buffers outlive their threads so that their events can still be written.
+std::mutex buffersMutex;
+std::vector<Buffer*> buffers;
+
+thread_local Buffer* localBuffer = NULL;
+
+Buffer* getLocalBuffer() {
+    if (localBuffer == NULL) {
+        Buffer* buffer = new Buffer;
+        buffer->first = buffer->last = new Chunk;
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        buffer->tid = buffers.size() + 1;
+        buffers.push_back(buffer);
+        localBuffer = buffer;
+    }
+    return localBuffer;
+}
+
+} /* namespace */
+
+bool Trace::isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void Trace::setEnabled(const bool enable) {
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+void Trace::record(const char* name,
+                   const char* category,
+                   const std::uint64_t begin,
+                   const std::uint64_t end,
+                   const std::size_t id) {
+    Buffer* buffer = getLocalBuffer();
+    Chunk* chunk = buffer->last;
+    std::size_t n = chunk->size.load(std::memory_order_relaxed);
+    if (n == Chunk::capacity) {
+        Chunk* next = new Chunk;
+        chunk->next.store(next, std::memory_order_release);
+        buffer->last = chunk = next;
+        n = 0;
+    }
+    Event& event = chunk->events[n];
+    event.name     = name;
+    event.category = category;
+    event.begin    = begin;
+    event.end      = end;
+    event.id       = id;
+    chunk->size.store(n + 1, std::memory_order_release);
+}
+
+void Trace::write(std::ostream& output) {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    // Events are recorded as their scopes end, enclosing scopes begin before
+    // the first one of their buffer.
+    std::uint64_t origin = std::numeric_limits<std::uint64_t>::max();
+    for (std::size_t b = 0; b < buffers.size(); ++b) {
+        const Chunk* chunk = buffers[b]->first;
+        while (chunk != NULL) {
+            const std::size_t n = chunk->size.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < n; ++i) {
+                origin = std::min(origin, chunk->events[i].begin);
+            }
+            chunk = chunk->next.load(std::memory_order_acquire);
+        }
+    }
+
+    output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    output << std::fixed << std::setprecision(3);
+    bool first = true;
+    for (std::size_t b = 0; b < buffers.size(); ++b) {
+        const std::size_t tid = buffers[b]->tid;
+        output << (first ? "" : ",") << std::endl
+               << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+               << "\"tid\":" << tid << ",\"args\":{\"name\":\"thread "
+               << tid << "\"}}";
+        first = false;
+        const Chunk* chunk = buffers[b]->first;
+        while (chunk != NULL) {
+            const std::size_t n = chunk->size.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < n; ++i) {
+                const Event& event = chunk->events[i];
+                output << "," << std::endl
+                       << "{\"name\":\"" << event.name << "\","
+                       << "\"cat\":\"" << event.category << "\","
+                       << "\"ph\":\"X\",\"pid\":1,\"tid\":" << tid << ","
+                       << "\"ts\":" << (event.begin - origin) * 1e-3 << ","
+                       << "\"dur\":" << (event.end - event.begin) * 1e-3;
+                if (event.id != noId) {
+                    output << ",\"args\":{\"id\":" << event.id << "}";
+                }
+                output << "}";
+            }
+            chunk = chunk->next.load(std::memory_order_acquire);
+        }
+    }
+    output << std::endl << "]}" << std::endl;
+}
+
+void Trace::clear() {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    for (std::size_t b = 0; b < buffers.size(); ++b) {
+        Chunk* chunk = buffers[b]->first->next.load();
+        while (chunk != NULL) {
+            Chunk* next = chunk->next.load();
+            delete chunk;
+            chunk = next;
+        }
+        buffers[b]->first->next.store(NULL);
+        buffers[b]->first->size.store(0);
+        buffers[b]->last = buffers[b]->first;
+    }
+}
+
+std::size_t Trace::size() {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    std::size_t res = 0;
+    for (std::size_t b = 0; b < buffers.size(); ++b) {
+        const Chunk* chunk = buffers[b]->first;
+        while (chunk != NULL) {
+            res += chunk->size.load(std::memory_order_acquire);
+            chunk = chunk->next.load(std::memory_order_acquire);
+        }
+    }
+    return res;
+}
+
+#else
+
+void Trace::setEnabled(const bool) {
+}
+
+void Trace::write(std::ostream& output) {
+    output << "{\"traceEvents\":[]}" << std::endl;
+}
+
+void Trace::clear() {
+}
+
+std::size_t Trace::size() {
+    return 0;
+}
+
+#endif
+
+void Trace::write(const std::string& filename) {
+    std::ofstream output(filename.c_str());
+    if (!output.is_open()) {
+        throw std::runtime_error("Unable to open " + filename);
+    }
+    write(output);
+}
+
+} /* namespace VectorFitting */
@@ -0,0 +1,113 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEMBA_VECTOR_FITTING_TRACE_H_
+#define SEMBA_VECTOR_FITTING_TRACE_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace VectorFitting {
+
+/**
+ * Records begin/end events from any thread and writes them as Chrome trace
+ * JSON, which Perfetto and chrome://tracing display. Each thread appends to
+ * its own buffer without locks; recording is off until setEnabled(true),
+ * and then costs two clock reads per event. Defining CompileWithoutTracing
+ * removes it altogether.
+ *
+ * Names and categories are not copied, they must be string literals.
+ */
+class Trace {
+public:
+    static const std::size_t noId = (std::size_t) -1;
+
+    static bool isEnabled();
+    static void setEnabled(const bool enabled);
+
+    // Nanoseconds of the clock used for the events.
+    static std::uint64_t now();
+
+    static void record(const char* name,
+                       const char* category,
+                       const std::uint64_t begin,
+                       const std::uint64_t end,
+                       const std::size_t id = noId);
+
+    /**
+     * Writes all the events recorded so far. Must not race with clear(),
+     * threads still recording only miss their latest events.
+     */
+    static void write(std::ostream& output);
+    static void write(const std::string& filename);
+
+    // Drops the recorded events. No thread may be recording meanwhile.
+    static void clear();
+
+    static std::size_t size();
+
+    // Event spanning the lifetime of the object.
+    class Scope {
+    public:
+        Scope(const char* name, const char* category,
+              const std::size_t id = noId);
+        ~Scope();
+    private:
+#ifndef CompileWithoutTracing
+        const char* name_;
+        const char* category_;
+        std::size_t id_;
+        std::uint64_t begin_;
+#endif
+    };
+};
+
+#ifdef CompileWithoutTracing
+inline bool Trace::isEnabled() { return false; }
+inline void Trace::record(const char*, const char*,
+                          const std::uint64_t, const std::uint64_t,
+                          const std::size_t) {}
+inline Trace::Scope::Scope(const char*, const char*, const std::size_t) {}
+inline Trace::Scope::~Scope() {}
+#else
+inline Trace::Scope::Scope(const char* name, const char* category,
+                           const std::size_t id)
+:   name_(name), category_(category), id_(id),
+    begin_(isEnabled() ? now() : 0) {}
+
+inline Trace::Scope::~Scope() {
+    if (begin_ != 0 && isEnabled()) {
+        record(name_, category_, begin_, now(), id_);
+    }
+}
+#endif
+
+inline std::uint64_t Trace::now() {
+    return (std::uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_TRACE_H_ */
@@ -0,0 +1,197 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Tuning.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace VectorFitting {
+
+namespace {
+
+std::string trim(const std::string& str) {
+    const std::size_t first = str.find_first_not_of(" \t\r");
+    if (first == std::string::npos) {
+        return std::string();
+    }
+    const std::size_t last = str.find_last_not_of(" \t\r");
+    return str.substr(first, last - first + 1);
+}
+
+Real toReal(const std::string& key, const std::string& value) {
+    char* end;
+    const double res = std::strtod(value.c_str(), &end);
+    if (value.empty() || *end != '\0' || !(res >= 0.0)) {
+        throw std::runtime_error("Invalid value of " + key + ": " + value);
+    }
+    return (Real) res;
+}
+
+std::size_t toSize(const std::string& key, const std::string& value) {
+    char* end;
+    const long res = std::strtol(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || res < 0) {
+        throw std::runtime_error("Invalid value of " + key + ": " + value);
+    }
+    return (std::size_t) res;
+}
+
+// The profile file is optional; a broken one is reported and ignored
+// rather than failing every program linked with the library.
+Tuning load() {
+    const std::string path = Tuning::getDefaultPath();
+    if (path.empty() || !std::ifstream(path.c_str()).good()) {
+        return Tuning();
+    }
+    try {
+        return Tuning::read(path);
+    } catch (const std::exception& e) {
+        std::cerr << "VectorFitting: ignoring tuning profile: " << e.what()
+                  << std::endl;
+        return Tuning();
+    }
+}
+
+Tuning& getInstance() {
+    static Tuning instance = load();
+    return instance;
+}
+
+} /* namespace */
+
+Tuning::Tuning() {
+    fitThreads   = 0;
+    batchThreads = 0;
+    normalEquationsCondition = 1e4;
+    normalEquationsMovement  = 1e-2;
+    // Conservative guesses, CostModel::calibrate() replaces them.
+    flopRate           = 1e9;
+    parallelEfficiency = 0.8;
+    overhead           = 1e-5;
+}
+
+const Tuning& Tuning::get() {
+    return getInstance();
+}
+
+void Tuning::set(const Tuning& tuning) {
+    getInstance() = tuning;
+}
+
+std::string Tuning::getDefaultPath() {
+    const char* path = std::getenv("VECTORFITTING_TUNING");
+    if (path != NULL && path[0] != '\0') {
+        return path;
+    }
+    const char* home = std::getenv("HOME");
+    if (home != NULL && home[0] != '\0') {
+        return std::string(home) + "/.vectorfitting/tuning";
+    }
+    return std::string();
+}
+
+Tuning Tuning::read(const std::string& filename) {
+    std::ifstream file(filename.c_str());
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open " + filename);
+    }
+    Tuning res;
+    std::string line;
+    while (std::getline(file, line)) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        const std::size_t equal = line.find('=');
+        if (equal == std::string::npos) {
+            throw std::runtime_error("Invalid line in " + filename + ": "
+                                     + line);
+        }
+        const std::string key   = trim(line.substr(0, equal));
+        const std::string value = trim(line.substr(equal + 1));
+        if (key == "fitThreads") {
+            res.fitThreads = toSize(key, value);
+        } else if (key == "batchThreads") {
+            res.batchThreads = toSize(key, value);
+        } else if (key == "normalEquationsCondition") {
+            res.normalEquationsCondition = toReal(key, value);
+        } else if (key == "normalEquationsMovement") {
+            res.normalEquationsMovement = toReal(key, value);
+        } else if (key == "flopRate") {
+            res.flopRate = toReal(key, value);
+        } else if (key == "parallelEfficiency") {
+            res.parallelEfficiency = toReal(key, value);
+        } else if (key == "overhead") {
+            res.overhead = toReal(key, value);
+        } else {
+            throw std::runtime_error("Unknown key in " + filename + ": "
+                                     + key);
+        }
+    }
+    if (res.flopRate <= 0.0 || res.parallelEfficiency <= 0.0 ||
+            res.parallelEfficiency > 1.0) {
+        throw std::runtime_error("Invalid cost model in " + filename);
+    }
+    return res;
+}
+
+void Tuning::write(const std::string& filename) const {
+    std::ofstream file(filename.c_str());
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open " + filename);
+    }
+    file.precision(std::numeric_limits<Real>::digits10 + 1);
+    file << "fitThreads = "               << fitThreads << std::endl
+         << "batchThreads = "             << batchThreads << std::endl
+         << "normalEquationsCondition = " << normalEquationsCondition
+         << std::endl
+         << "normalEquationsMovement = "  << normalEquationsMovement
+         << std::endl
+         << "flopRate = "                 << flopRate << std::endl
+         << "parallelEfficiency = "       << parallelEfficiency << std::endl
+         << "overhead = "                 << overhead << std::endl;
+    if (!file) {
+        throw std::runtime_error("Unable to write " + filename);
+    }
+}
+
+int Tuning::getThreads(const std::size_t threads) {
+    if (threads != 0) {
+        return (int) threads;
+    }
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+} /* namespace VectorFitting */
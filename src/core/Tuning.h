@@ -0,0 +1,76 @@
+// OpenSEMBA
+// Copyright (C) 2015 Salvador Gonzalez Garcia        (salva@ugr.es)
+//                    Luis Manuel Diaz Angulo         (lmdiazangulo@semba.guru)
+//                    Miguel David Ruiz-Cabello Nuñez (miguel@semba.guru)
+//                    Daniel Mateos Romero            (damarro@semba.guru)
+//
+// This file is part of OpenSEMBA.
+//
+// OpenSEMBA is free software: you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option)
+// any later version.
+//
+// OpenSEMBA is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with OpenSEMBA. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SEMBA_VECTOR_FITTING_TUNING_H_
+#define SEMBA_VECTOR_FITTING_TUNING_H_
+
+#include <cstddef>
+#include <string>
+
+#include "Types.h"
+
+namespace VectorFitting {
+
+/**
+ * Host dependent defaults of the library, written by vfittune. The profile
+ * is read once, on first use, from the file named by the environment
+ * variable VECTORFITTING_TUNING or else from $HOME/.vectorfitting/tuning;
+ * without one the built-in defaults apply. Explicit settings, such as
+ * BatchFitter::setThreads(), always take precedence.
+ *
+ * Profiles are "key = value" lines, # starts a comment.
+ */
+struct Tuning {
+    // Threads of the per response loop of fit(), zero for the OpenMP
+    // default.
+    std::size_t fitThreads;
+    // Default of BatchFitter::setThreads(), zero for the OpenMP default.
+    std::size_t batchThreads;
+    // The adaptive solver policy takes normal equations below both, zero
+    // condition disables them.
+    Real normalEquationsCondition;
+    Real normalEquationsMovement;
+    // Initial CostModel parameters, see CostModel::calibrate().
+    Real flopRate;
+    Real parallelEfficiency;
+    Real overhead;
+
+    Tuning();
+
+    // The profile in use.
+    static const Tuning& get();
+    // Replaces the profile in use, no fit may be running meanwhile.
+    static void set(const Tuning& tuning);
+
+    // Empty when there is no environment variable nor home directory.
+    static std::string getDefaultPath();
+
+    static Tuning read(const std::string& filename);
+    void write(const std::string& filename) const;
+
+    // Threads for a setting where zero means the OpenMP default.
+    static int getThreads(const std::size_t threads);
+};
+
+} /* namespace VectorFitting */
+
+#endif /* SEMBA_VECTOR_FITTING_TUNING_H_ */
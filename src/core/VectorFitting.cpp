@@ -22,15 +22,56 @@
 
 #include "VectorFitting.h"
 #include "SpaceGenerator.h"
-
+#include "Assembly.h"
+#include "BasisCache.h"
+#include "Cauchy.h"
+#include "Reducer.h"
+#include "SampleSet.h"
+#include "CostModel.h"
+#include "Trace.h"
+#include "Tuning.h"
+
+#include <algorithm>
 #include <iostream>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace VectorFitting {
 
+namespace {
+
+// Keeps Eigen's products on the calling thread while alive: their blocking,
+// and so their rounding, depends on the number of threads they get.
+class SerialEigenScope {
+public:
+    explicit SerialEigenScope(const bool enabled) : threads_(0) {
+#ifdef _OPENMP
+        if (enabled) {
+            threads_ = omp_get_max_threads();
+            omp_set_num_threads(1);
+        }
+#endif
+    }
+    ~SerialEigenScope() {
+#ifdef _OPENMP
+        if (threads_ != 0) {
+            omp_set_num_threads(threads_);
+        }
+#endif
+    }
+private:
+    int threads_;
+};
+
+} /* namespace */
+
 // Custom ordering for the samples, depending on the imaginary parts of the
 // frequencies
 struct {
-    bool operator()(Sample a, Sample b)
+    bool operator()(const Sample& a, const Sample& b)
     {
         return a.first.imag() < b.first.imag();
     }
@@ -55,11 +96,14 @@ bool isReal(Complex n){
     return equal(n.imag(), 0.0);
 }
 
-void VectorFitting::init(const std::vector<Sample>& samples,
+void VectorFitting::init(const std::shared_ptr<const SampleSet>& data,
                          const std::vector<Complex>& poles,
-                         const Options& options,
-                         const std::vector<std::vector<Real>>& weights) {
+                         const Options& options) {
     options_ = options;
+    reducer_ = NULL;
+    basisCache_ = NULL;
+    threads_ = 0;
+    frozen_ = 0;
 
     // Sanity check: the complex poles should come in pairs; otherwise, there
     // is an error
@@ -73,48 +117,108 @@ void VectorFitting::init(const std::vector<Sample>& samples,
         }
     }
 
-    samples_ = samples;
+    data_ = data;
     poles_ = VectorXcd::Zero(poles.size());
     for (size_t i = 0; i < poles.size(); ++i) {
         poles_(i) = poles[i];
     }
-    if (weights.size() != 0 && weights.size() != samples.size()) {
-        throw std::runtime_error("Weights and samples must have same size.");
-    }
-    if (weights.size() == 0) {
-        weights_ = MatrixXd::Ones(getSamplesSize(), getResponseSize());
-    } else {
-        weights_ = MatrixXd::Zero(getSamplesSize(), getResponseSize());
-        for (size_t i = 0; i < getSamplesSize(); ++i) {
-            if (weights[i].size() != getResponseSize()) {
-                throw std::runtime_error(
-                        "All weights must have the same size as the samples");
-            }
-            for (size_t j = 0; j < getResponseSize(); ++j) {
-                weights_(i,j) = weights[i][j];
-            }
-        }
-    }
 }
 
 VectorFitting::VectorFitting(const std::vector<Sample>& samples,
         const std::vector<Complex>& poles,
         const Options& options,
         const std::vector<std::vector<Real>>& weights) {
-    if (samples.size() == 0) {
-        throw std::runtime_error("Samples size cannot be zero");
-    }
-    init(samples, poles, options, weights);
+    init(SampleSet::build(samples, weights), poles, options);
 }
 
 VectorFitting::VectorFitting(const std::vector<Sample>& samples,
         const size_t order,
         const Options& options,
         const std::vector<std::vector<Real>>& weights) {
+    const std::shared_ptr<const SampleSet> data =
+            SampleSet::build(samples, weights);
+    init(data, getStartingPoles(*data, order), options);
+}
+
+VectorFitting::VectorFitting(const std::shared_ptr<const SampleSet>& data,
+        const std::vector<Complex>& poles,
+        const Options& options) {
+    if (!data) {
+        throw std::runtime_error("Samples size cannot be zero");
+    }
+    init(data, poles, options);
+}
+
+std::vector<Complex> VectorFitting::getStartingPoles(
+        const std::vector<Sample>& samples,
+        const size_t order) {
     if (samples.size() == 0) {
         throw std::runtime_error("Samples size cannot be zero");
     }
-    if (order % 2 == 0) {
+    // Get range of the samples frequencies:
+    const Sample& minSample =
+            *min_element(samples.begin(), samples.end(), sampleOrdering);
+    const Sample& maxSample =
+            *max_element(samples.begin(), samples.end(), sampleOrdering);
+    return getStartingPoles(
+            std::make_pair(minSample.first.imag(), maxSample.first.imag()),
+            order);
+}
+
+std::vector<Complex> VectorFitting::getStartingPoles(const SampleSet& data,
+                                                     const size_t order) {
+    return getStartingPoles(data.getFrequencyRange(), order);
+}
+
+std::vector<Complex> VectorFitting::getRefinedPoles(
+        const SampleSet& data,
+        const std::vector<Complex>& poles,
+        const std::vector<Real>& errors,
+        const size_t pairs) {
+    const VectorXcd& frequencies = data.getFrequencies();
+    const size_t Ns = frequencies.size();
+    if (errors.size() != Ns) {
+        throw std::runtime_error("There must be an error for each sample");
+    }
+    // Samples need not be sorted, peaks are local maxima along frequency.
+    std::vector<size_t> order(Ns);
+    for (size_t i = 0; i < Ns; ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return frequencies(a).imag() < frequencies(b).imag();
+    });
+    // Ends are mirrored, plateaus count once, at their first sample.
+    std::vector<std::pair<Real, Real>> peaks;  // Error and frequency.
+    for (size_t k = 0; k < Ns; ++k) {
+        const Real error = errors[order[k]];
+        const Real frequency = std::imag(frequencies(order[k]));
+        Real prev = -1.0, next = -1.0;
+        if (Ns > 1) {
+            prev = errors[order[k > 0    ? k-1 : 1   ]];
+            next = errors[order[k+1 < Ns ? k+1 : Ns-2]];
+        }
+        if (prev < error && next <= error && greater(frequency, 0.0)) {
+            peaks.push_back(std::make_pair(error, frequency));
+        }
+    }
+    std::sort(peaks.begin(), peaks.end(),
+              std::greater<std::pair<Real, Real>>());
+
+    // Same shape as the default starting poles.
+    std::vector<Complex> res = poles;
+    for (size_t k = 0; k < std::min(pairs, peaks.size()); ++k) {
+        const Real imag = peaks[k].second;
+        res.push_back(Complex(- imag / (Real) 100.0,  imag));
+        res.push_back(Complex(- imag / (Real) 100.0, -imag));
+    }
+    return res;
+}
+
+std::vector<Complex> VectorFitting::getStartingPoles(
+        const std::pair<Real, Real>& range,
+        const size_t order) {
+    if (order % 2 != 0) {
         throw std::runtime_error("Default starting poles are complex, order must be even");
     }
 
@@ -124,11 +228,6 @@ VectorFitting::VectorFitting(const std::vector<Sample>& samples,
     //      1. imagParts = linspace(range(samples), number_of_poles)
     //      2. realParts = imagParts / 100
 
-    // Get range of the samples frequencies:
-    Sample minSample = *min_element(samples.begin(), samples.end(), sampleOrdering);
-    Sample maxSample = *max_element(samples.begin(), samples.end(), sampleOrdering);
-    std::pair<Real, Real> range(minSample.first.imag(), maxSample.first.imag());
-
     // Generate the imaginary parts of the initial poles from a linear
     // distribution covering the range in the samples.
     // This can also be done with a logarithmic distribution (sometimes
@@ -144,71 +243,68 @@ VectorFitting::VectorFitting(const std::vector<Sample>& samples,
         poles[i] = Complex(real, imag);
         poles[i+1] = conj(poles[i]);
     }
-
-    init(samples, poles, options, weights);
+    return poles;
 }
 
-void VectorFitting::fit(){
+Statistics VectorFitting::fit(){
     // Following Gustavssen notation in vectfit3.m .
     const size_t Ns = getSamplesSize();
     const size_t N  = getOrder();
     const size_t Nc = getResponseSize();
+    const MatrixXd& weights = data_->getWeights();
+    const MatrixXcd& responses = data_->getResponses();
 
-    VectorXcd SERD(Nc), SERE(Nc);
+    Options::Solver solver = options_.getSolver();
+    if (solverPolicy_) {
+        solver = solverPolicy_(statistics_.health);
+    }
+    statistics_ = Statistics();
+    statistics_.iterations = 1;
+    Health& health = statistics_.health;
+    health.solver = solver;
+    Statistics::Stopwatch stopwatch(statistics_);
+
+    const int threads = Tuning::getThreads(
+            threads_ != 0 ? threads_ : Tuning::get().fitThreads);
+    const bool reproducible = options_.isReproducible();
+    SerialEigenScope serialEigen(reproducible);
+
+    VectorXcd SERD = VectorXcd::Zero(Nc);
+    VectorXcd SERE = VectorXcd::Zero(Nc);
     VectorXi SERB(N);
     RowVectorXcd SERA(1,N);
     MatrixXcd  SERC(Nc, N);
     for (size_t i = 0; i < N; ++i) {
         SERA(0,i) = poles_[i];
     }
-    VectorXcd roetter;
+    // Unless identified below.
+    VectorXcd roetter = poles_;
 
     // --- Pole identification ---
-    if (!options_.isSkipPoleIdentification()) {
+    if (!options_.isSkipPoleIdentification() && frozen_ < N) {
+        stopwatch.start(Statistics::basis);
+        health.reusedColumns += updateBasis(poles_);
+        const MatrixXcd& Dk = *basis_.Dk;
+
+        // Only the first Nf poles are relocated, frozen ones follow them.
+        // Their columns stay in the left block, projected out by the QR of
+        // each response, and leave sigma and its zeros to the free poles.
+        const size_t Nf = N - frozen_;
 
         // Finds out which starting poles are complex.
-        RowVectorXi cindex = getCIndex(poles_);
+        RowVectorXi cindex = getCIndex(poles_).head(Nf);
 
         // Builds system - matrix.
-        MatrixXcd LAMBD = MatrixXcd::Zero(N, N);
-        for (size_t i = 0; i < N; ++i) {
+        MatrixXcd LAMBD = MatrixXcd::Zero(Nf, Nf);
+        for (size_t i = 0; i < Nf; ++i) {
             LAMBD(i,i) = poles_[i];
         }
 
-        MatrixXcd Dk = MatrixXcd::Zero(Ns,N+2);
-        MatrixXcd LAMBDprime = LAMBD.transpose().conjugate();
-        for (size_t m = 0; m < N; ++m) {
-            if (cindex(m) == 0) { // Real pole.
-                for (size_t i = 0; i < Ns; ++i) {
-                    Dk(i,m) = Complex(1,0) / (samples_[i].first - LAMBD(m,m));
-                }
-            } else if (cindex(m) == 1) { // Complex pole, first part.
-                for (size_t i = 0; i < Ns; ++i) {
-                    Dk(i,m)   = Complex(1,0) / (samples_[i].first - LAMBD(m,m))
-                               + Complex(1,0) / (samples_[i].first - LAMBDprime(m,m));
-                    Dk(i,m+1) = Complex(0,1) / (samples_[i].first - LAMBD(m,m))
-                               - Complex(0,1) / (samples_[i].first - LAMBDprime(m,m));
-                }
-            }
-        }
-        for (size_t i = 0; i < Ns; ++i) {
-            Dk(i,N) = (Real) 1.0;
-            if (options_.getAsymptoticTrend() == Options::linear) {
-                Dk(i,N+1) = samples_[i].first;
-            }
-        }
-        // Scaling for last row of LS-problem (pole identification).
-        Real scale = 0.0;
-        for (size_t m = 0; m < Nc; ++m) {
-            for (size_t i = 0; i < Ns; ++i) {
-                const Real weight = weights_(i,m);
-                const Complex sample = samples_[i].second[m];
-                scale += std::pow(std::abs(weight * std::conj(sample)), 2);
-            }
-        }
-        scale = std::sqrt(scale) / (Real) Ns;
+        // Scaling for last row of LS-problem (pole identification). Cached
+        // by the sample set, summed serially in a fixed order.
+        const Real scale = data_->getScale();
 
-        VectorXd x(N+1);
+        VectorXd x(Nf+1);
 
         if (options_.isRelax()) {
             size_t offs;
@@ -224,88 +320,187 @@ void VectorFitting::fit(){
                 break;
             }
 
-            // Computes AA and bb.
-            MatrixXd AA = MatrixXd::Zero(Nc*(N+1), N+1);
-            VectorXd bb = VectorXd::Zero(Nc*(N+1));
-            for (size_t n = 0; n < Nc; ++n) {
-                MatrixXd A = MatrixXd::Zero(2*Ns+1, (N+offs)+N+1);
-                VectorXd weig(Ns);
-                for (size_t i = 0; i < Ns; ++i) {
-                    weig(i) = weights_(i,n);
-                }
-                // Left block.
-                for (size_t m = 0; m < N + offs; ++m) {
-                    for (size_t i = 0; i < Ns; ++i) {
-                        const Complex entry = weig(i) * Dk(i,m);
-                        A(i   ,m) = std::real(entry);
-                        A(i+Ns,m) = std::imag(entry);
-                    }
-                }
-                // Right block.
-                const size_t inda = N + offs;
-                for (size_t m = 0; m < N+1; ++m) {
-                    for (size_t i = 0; i < Ns; ++i) {
-                        const Complex entry =
-                         - weig(i) * Dk(i,m) * samples_[i].second[n];
-                        A(i   ,inda+m) = std::real(entry);
-                        A(i+Ns,inda+m) = std::imag(entry);
-                    }
-                }
+            // Each response contributes the R22 block of its own QR, and
+            // the last one also the projected integral criterion. Their
+            // stacking is reduced on the fly (TSQR), in parallel over the
+            // responses, instead of storing the Nc*(Nf+1) rows of AA.
+            // Reproducible runs give each block of responses its own factor,
+            // whatever thread gets it, and merge the blocks along a fixed
+            // tree.
+            std::pair<size_t, size_t> range(0, Nc);
+            if (reducer_ != NULL) {
+                range = reducer_->getResponseRange(Nc);
+            }
+            const size_t count = range.second - range.first;
+            stopwatch.start(Statistics::assembly, count);
+            MatrixXd AA(0, Nf+1);
+            VectorXd bb(0);
+            const size_t blockSize = Options::reproducibleBlockSize;
+            const size_t blocks = (count + blockSize - 1) / blockSize;
+            std::vector<MatrixXd> blockAA;
+            std::vector<VectorXd> blockbb;
+            if (reproducible) {
+                blockAA.resize(blocks, MatrixXd(0, Nf+1));
+                blockbb.resize(blocks, VectorXd(0));
+            }
+            // A static schedule runs each chunk on one thread, in order.
+            const long chunk = reproducible ?
+                    (long) blockSize :
+                    std::max<long>(1, ((long) count + threads - 1) / threads);
+#pragma omp parallel if (count > 1) num_threads(threads)
+            {
+            MatrixXd localAA(0, Nf+1);
+            VectorXd localbb(0);
+            Real localBasisCondition = 0.0;
+            Real localCondition = 0.0;
+            size_t localFallbacks = 0;
+#pragma omp for schedule(static, chunk) nowait
+            for (long nn = (long) range.first; nn < (long) range.second; ++nn) {
+                const size_t n = (size_t) nn;
+                Trace::Scope trace("response", "fit", n);
+                MatrixXd A;
+                Assembly::buildPoleSystem(Dk, N+offs, Nf+1, weights,
+                                          responses, n, A, frozen_);
 
                 // Integral criterion for sigma.
                 const size_t offset = N + offs;
                 if (n == Nc-1) {
-                    for (size_t mm = 0; mm < N+1; ++mm) {
-                        A(2*Ns, offset+mm) = std::real(scale*Dk.col(mm).sum());
+                    for (size_t mm = 0; mm < Nf+1; ++mm) {
+                        const size_t col = mm < Nf ? mm : N;
+                        A(2*Ns, offset+mm) = std::real(scale*Dk.col(col).sum());
                     }
                 }
 
-                // Performs QR decomposition.
-                MatrixXd Q, R;
-                HouseholderQR<MatrixXd> qr(A.rows(), A.cols());
-                qr.compute(A);
-                Q = qr.householderQ() * MatrixXd::Identity(A.rows(),A.cols());
-                R = Q.transpose() * A;
-
                 const size_t ind = N + offs;
-                MatrixXd R22 = R.block(ind,ind, N+1,N+1);
-                AA.block(n*(N+1), 0, N+1, N+1) = R22;
-                if (n == Nc-1) {
-                    for (size_t i = 0; i < N+1; ++i) {
-                        bb(i + n*(N+1)) = Q(2*Ns, N + offs + i)
-                                * (Real) Ns * (Real) scale;
+                MatrixXd R22;
+                VectorXd b22 = VectorXd::Zero(Nf+1);
+                VectorXd diagonal;
+                if (solver == Options::normalEquations) {
+                    // The Cholesky factor of A^T A is R up to the signs of
+                    // its rows, which leave the reduced problem unchanged.
+                    MatrixXd G = MatrixXd::Zero(A.cols(), A.cols());
+                    G.selfadjointView<Lower>().rankUpdate(A.transpose());
+                    LLT<MatrixXd> llt(G);
+                    if (llt.info() == Success) {
+                        const MatrixXd L = llt.matrixL();
+                        R22 = L.block(ind,ind, Nf+1,Nf+1).transpose();
+                        if (n == Nc-1) {
+                            VectorXd row = A.row(2*Ns).transpose();
+                            llt.matrixL().solveInPlace(row);
+                            b22 = row.tail(Nf+1) * (Real) Ns * (Real) scale;
+                        }
+                        diagonal = L.diagonal();
+                    } else {
+                        localFallbacks++;
                     }
                 }
+                if (diagonal.size() == 0) {
+                    // Performs QR decomposition.
+                    MatrixXd Q, R;
+                    HouseholderQR<MatrixXd> qr(A.rows(), A.cols());
+                    qr.compute(A);
+                    Q = qr.householderQ()
+                      * MatrixXd::Identity(A.rows(),A.cols());
+                    R = Q.transpose() * A;
+
+                    R22 = R.block(ind,ind, Nf+1,Nf+1);
+                    if (n == Nc-1) {
+                        for (size_t i = 0; i < Nf+1; ++i) {
+                            b22(i) = Q(2*Ns, N + offs + i)
+                                    * (Real) Ns * (Real) scale;
+                        }
+                    }
+                    diagonal = qr.matrixQR().diagonal();
+                }
+                localBasisCondition = std::max(localBasisCondition,
+                        getConditionEstimate(diagonal.head(ind)));
+                localCondition = std::max(localCondition,
+                                          getConditionEstimate(diagonal));
+                if (reproducible) {
+                    const size_t block = (n - range.first) / blockSize;
+                    Reducer::merge(blockAA[block], blockbb[block], R22, b22);
+                } else {
+                    Reducer::merge(localAA, localbb, R22, b22);
+                }
             }  // End of for loop n=1:Nc
+            if (reproducible) {
+#pragma omp barrier
+                for (size_t stride = 1; stride < blocks; stride *= 2) {
+#pragma omp for schedule(static)
+                    for (long i = 0; i < (long) (blocks - stride);
+                            i += (long) (2*stride)) {
+                        Reducer::merge(blockAA[i], blockbb[i],
+                                       blockAA[i+stride], blockbb[i+stride]);
+                    }
+                }
+            }
+#pragma omp critical
+            {
+            Reducer::merge(AA, bb, localAA, localbb);
+            health.basisCondition =
+                    std::max(health.basisCondition, localBasisCondition);
+            health.systemCondition =
+                    std::max(health.systemCondition, localCondition);
+            health.fallbacks += localFallbacks;
+            }
+            }
+            if (reproducible && blocks > 0) {
+                AA.swap(blockAA[0]);
+                bb.swap(blockbb[0]);
+            }
+            if (AA.rows() == 0) {
+                AA = MatrixXd::Zero(Nf+1, Nf+1);
+                bb = VectorXd::Zero(Nf+1);
+            }
+            if (reducer_ != NULL) {
+                reducer_->reduce(AA, bb);
+            }
 
-            // Computes scaling factor.
-            VectorXd Escale = VectorXd::Zero(N+1);
-            for (size_t col = 0; col < N+1; ++col) {
+            stopwatch.start(Statistics::solve);
+            // Computes scaling factor. Column norms of the reduced factor
+            // are those of the stacked AA, taken serially.
+            VectorXd Escale = VectorXd::Zero(Nf+1);
+            for (size_t col = 0; col < Nf+1; ++col) {
                 Escale(col) = 1.0 / AA.col(col).norm();
-                for (size_t i = 0; i < Nc*(N+1); ++i) {
+                for (size_t i = 0; i < Nf+1; ++i) {
                     AA(i,col) = Escale(col) * AA(i,col);
                 }
             }
 
-            x = AA.householderQr().solve(bb);
-            for (size_t i = 0; i < N+1; ++i) {
+            switch (solver) {
+            case Options::householder:
+                x = AA.householderQr().solve(bb);
+                break;
+            case Options::normalEquations:
+                // AA is already triangular.
+                x = AA.triangularView<Upper>().solve(bb);
+                break;
+            case Options::columnPivoting:
+                x = AA.colPivHouseholderQr().solve(bb);
+                break;
+            }
+            for (size_t i = 0; i < Nf+1; ++i) {
                 x(i) *= Escale(i);
             }
+            health.valid = true;
+            health.reducedCondition = getConditionEstimate(AA.diagonal());
+            health.escaleSpread = Escale.maxCoeff() / Escale.minCoeff();
+            health.sigmaD = std::abs(x(Nf));
 
         } // End of if for "relax" flag.
 
         if (!options_.isRelax()
                 || lower  (std::abs(x(0)), toleranceLow_)
-                || greater(std::abs(x(N)), toleranceHigh_) ) {
+                || greater(std::abs(x(Nf)), toleranceHigh_) ) {
             throw std::runtime_error("Option to do not relax is not implemented");
             // TODO Implement this.
         }
 
-        VectorXcd C = VectorXcd::Zero(N);
+        VectorXcd C = VectorXcd::Zero(Nf);
         for (int i = 0; i < x.rows()-1; ++i) {
             C(i) = x(i);
         }
-        for (size_t m = 0; m < N; ++m) {
+        for (size_t m = 0; m < Nf; ++m) {
             if (cindex(m) == 1) {
                 const Real r1 = std::real(C(m  ));
                 const Real r2 = std::real(C(m+1));
@@ -316,10 +511,11 @@ void VectorFitting::fit(){
         Real D = x(x.rows()-1);
 
         // Calculates the zeros for sigma.
-        VectorXi B = VectorXi::Ones(N);
+        stopwatch.start(Statistics::eigen);
+        VectorXi B = VectorXi::Ones(Nf);
         size_t m = 0;
-        for (size_t n = 0; n < N; ++n) {
-            if (m < N) {
+        for (size_t n = 0; n < Nf; ++n) {
+            if (m < Nf) {
                 if (greater(std::abs(LAMBD(m,m)),
                             std::abs(std::real(LAMBD(m,m))))) {
                     LAMBD(m+1,m  ) = - std::imag(LAMBD(m,m));
@@ -338,22 +534,22 @@ void VectorFitting::fit(){
         }
 
         // Checks LAMBD and C are purely real.
-        for (size_t i = 0; i < N; ++i) {
-            for (size_t j = 0; j < N; ++j) {
+        for (size_t i = 0; i < Nf; ++i) {
+            for (size_t j = 0; j < Nf; ++j) {
                 if (!equal(std::imag(LAMBD(i,j)), 0.0)) {
                     throw std::runtime_error("LAMBD is not purely real");
                 }
             }
         }
-        for (size_t i = 0; i < N; ++i) {
+        for (size_t i = 0; i < Nf; ++i) {
             if (!equal(std::imag(C(i)), 0.0)) {
                 throw std::runtime_error("LAMBD is not purely real");
             }
         }
 
-        MatrixXd ZER = MatrixXd::Zero(N,N);
-        for (size_t i = 0; i < N; ++i) {
-            for (size_t j = 0; j < N; ++j) {
+        MatrixXd ZER = MatrixXd::Zero(Nf,Nf);
+        for (size_t i = 0; i < Nf; ++i) {
+            for (size_t j = 0; j < Nf; ++j) {
                 ZER(i,j) = std::real(LAMBD(i,j)) - (Real) B(i) * std::real(C(j)) / D;
             }
         }
@@ -361,7 +557,7 @@ void VectorFitting::fit(){
         // Stores roetter
         roetter = EigenSolver<MatrixXd>(ZER, false).eigenvalues();
         if (options_.isStable()) {
-            for (size_t i = 0; i < N; ++i) {
+            for (size_t i = 0; i < Nf; ++i) {
                 const Real realPart = std::real(roetter(i));
                 if (greater(realPart, 0.0)) {
                     roetter(i) = roetter(i) - 2.0 * realPart;
@@ -408,16 +604,17 @@ void VectorFitting::fit(){
 //            }
 //        }
 
+        stopwatch.start(Statistics::sorting);
         // Alternative way of sorting.
         // First pure real poles in ascending order.
         // Then complex poles in ascending order by imaginary part.
-        std::vector<Complex> aux(N);
-        for (size_t m = 0; m < N; ++m) {
+        std::vector<Complex> aux(Nf);
+        for (size_t m = 0; m < Nf; ++m) {
             aux[m] = Complex(std::abs(std::imag(roetter(m))),
                              std::abs(std::real(roetter(m))));
         }
         std::sort(aux.begin(), aux.end(), complexOrdering);
-        for (size_t m = 0; m < N; ++m) {
+        for (size_t m = 0; m < Nf; ++m) {
             if (equal(aux[m].real(), 0.0)) {
                 roetter(m) = Complex(-std::imag(aux[m]), std::real(aux[m]));
             } else {
@@ -427,89 +624,66 @@ void VectorFitting::fit(){
             }
         }
 
+        // Frozen poles follow the relocated ones unchanged.
+        roetter.conservativeResize(N);
+        roetter.tail(frozen_) = poles_.tail(frozen_);
+
         // Stores results for poles.
+        health.poleMovement = getPoleMovement(poles_, roetter);
         SERA = roetter;
 
     } // End of if for "skip pole identification" flag.
 
     // --- Residue identification ---
     if (!options_.isSkipResidueIdentification()) {
+        stopwatch.start(Statistics::basis);
         // We now calculate SER for f, using the modified zeros of sigma
-        // as new poles.
+        // as new poles. The columns of the asymptotic trend follow those of
+        // the poles.
+        size_t offs = 0;
+        switch (options_.getAsymptoticTrend()) {
+        case Options::zero:
+            offs = 0;
+            break;
+        case Options::constant:
+            offs = 1;
+            break;
+        case Options::linear:
+            offs = 2;
+            break;
+        }
+        health.reusedColumns += updateBasis(roetter);
+        const MatrixXcd& Dk = *basis_.Dk;
         VectorXcd LAMBD = roetter;
         RowVectorXi cindex = getCIndex(LAMBD);
 
-        // We now calculate the SER for f (new fitting), using the above
-        // calculated zeros as known poles.
-        MatrixXcd Dk = MatrixXcd::Zero(Ns,N);
-        for (size_t m = 0; m < N; ++m) {
-            for (size_t i = 0; i < Ns; ++i) {
-                if (cindex(m) == 0) {
-                    Dk(i,m) = Complex(1,0) / (samples_[i].first - LAMBD(m));
-                } else if (cindex(m) == 1) {
-                    Dk(i,m)   = Complex(1,0) / (samples_[i].first - LAMBD(m))
-                                      + Complex(1,0) / (samples_[i].first - std::conj(LAMBD(m)));
-                    Dk(i,m+1) = Complex(0,1) / (samples_[i].first - LAMBD(m))
-                                      - Complex(0,1) / (samples_[i].first - std::conj(LAMBD(m)));
-                }
-            }
+        std::pair<size_t, size_t> range(0, Nc);
+        if (reducer_ != NULL) {
+            range = reducer_->getResponseRange(Nc);
         }
-
+        const size_t count = range.second - range.first;
+        stopwatch.start(Statistics::residues, count);
+        // Computes scaling factor, of every response at once.
+        const MatrixXd Escale = Assembly::getColumnNorms(Dk, N+offs, weights);
+        // Responses are independent systems, solved in parallel with the
+        // threads of pole identification, each with its own workspace. Each
+        // response writes only its row of C and its entries of SERD and
+        // SERE, and its result does not depend on the thread that gets it.
         MatrixXcd C  = MatrixXcd::Zero(Nc,N);
-        for (size_t n = 0; n < Nc; ++n) {
-            VectorXcd BB = VectorXcd::Zero(2*Ns);
-            MatrixXcd A;
-            switch (options_.getAsymptoticTrend()) {
-            case Options::zero:
-                A = MatrixXcd::Zero(2*Ns, N);
-                break;
-            case Options::constant:
-                A = MatrixXcd::Zero(2*Ns, N+1);
-                break;
-            case Options::linear:
-                A = MatrixXcd::Zero(2*Ns, N+2);
-                break;
-            }
-            for (size_t i = 0; i < Ns; ++i) {
-                for (size_t j = 0; j < N; ++j) {
-                    A (i    ,j) =   std::real(Dk(i,j)) * weights_(i,n);
-                    A (i+Ns ,j) =   std::imag(Dk(i,j)) * weights_(i,n);
-                    BB(i)    = std::real(samples_[i].second[n]) * weights_(i,n);
-                    BB(i+Ns) = std::imag(samples_[i].second[n]) * weights_(i,n);
-                }
-            }
-            switch (options_.getAsymptoticTrend()) {
-            case Options::zero:
-                break;
-            case Options::constant:
-                for (size_t i = 0; i < Ns; ++i) {
-                    A(i,    N) = 1.0 * weights_(i,n);
-                    A(i+Ns, N) = 0.0 * weights_(i,n);
-                }
-                break;
-            case Options::linear:
-                for (size_t i = 0; i < Ns; ++i) {
-                    A(i,    N  ) = 1.0 * weights_(i,n);
-                    A(i+Ns, N  ) = 0.0 * weights_(i,n);
-                    A(i,    N+1) = std::real(samples_[i].first) * weights_(i,n);
-                    A(i+Ns, N+1) = std::imag(samples_[i].first) * weights_(i,n);
-                }
-                break;
-            }
-
-            // Computes scaling factor.
-            VectorXd Escale(A.cols());
-            for (int col = 0; col < A.cols(); ++col) {
-                Escale(col) = A.col(col).norm();
-                for (int i = 0; i < A.rows(); ++i) {
-                    A(i,col) = A(i,col) / Escale(col);
-                }
-            }
-
-            //VectorXcd x = (A.transpose() * A).inverse() * A.transpose() * BB;
-            MatrixXcd X = A.householderQr().solve(BB);
+#pragma omp parallel if (count > 1) num_threads(threads)
+        {
+        MatrixXd A;
+        VectorXd BB;
+#pragma omp for schedule(static)
+        for (long nn = (long) range.first; nn < (long) range.second; ++nn) {
+            const size_t n = (size_t) nn;
+            Trace::Scope trace("residue", "fit", n);
+            Assembly::buildResidueSystem(Dk, N+offs, weights, responses,
+                                         Escale, n, A, BB);
+
+            VectorXd X = A.householderQr().solve(BB);
             for (int i = 0; i < A.cols(); ++i) {
-                X(i) /= Escale(i);
+                X(i) /= Escale(i,n);
             }
 
             // Stores results for response;
@@ -528,6 +702,10 @@ void VectorFitting::fit(){
                 break;
             }
         } // End of loop over Nc responses.
+        }
+        if (reducer_ != NULL) {
+            reducer_->gather(C, SERD, SERE);
+        }
 
         for (size_t m = 0; m < N; ++m) {
             if (cindex(m) == 1) {
@@ -544,6 +722,29 @@ void VectorFitting::fit(){
         SERB = VectorXi::Ones(N);
         SERC = C;
     } // End of if for "skip residue identification" flag.
+    stopwatch.stop();
+#ifndef CompileWithoutStatistics
+    {
+        CostModel::Problem problem;
+        problem.Ns = Ns;
+        problem.N  = N;
+        problem.Nc = Nc;
+        problem.frozen = frozen_;
+        if (reducer_ != NULL) {
+            const std::pair<size_t, size_t> range =
+                    reducer_->getResponseRange(Nc);
+            problem.Nc = range.second - range.first;
+        }
+        problem.options = options_;
+        problem.options.setSolver(solver);
+        const CostModel::Estimate estimate = CostModel().estimate(problem);
+        statistics_.flops[Statistics::basis]    = estimate.basisFlops;
+        statistics_.flops[Statistics::assembly] = estimate.poleFlops;
+        statistics_.flops[Statistics::solve]    = estimate.solveFlops;
+        statistics_.flops[Statistics::eigen]    = estimate.eigenFlops;
+        statistics_.flops[Statistics::residues] = estimate.residueFlops;
+    }
+#endif
 
     A_ = MatrixXcd::Zero(N,N);
     for (size_t i = 0; i < N; ++i) {
@@ -592,47 +793,50 @@ void VectorFitting::fit(){
 //            n++;
 //        }
 //    }
+    return statistics_;
 }
 
-/**
- * Return the fitted samples: a vector of pairs s <-> f(s), where f(s) is
- * computed with the model in (2).
- * @return A std::vector of Samples obtained with the fitted parameters.
- */
-std::vector<Sample> VectorFitting::getFittedSamples() const {
+MatrixXcd VectorFitting::getFittedResponses() const {
     const size_t N  = getOrder();
-    const size_t Ns = getSamplesSize();
     const size_t Nc = getResponseSize();
+    const VectorXcd& frequencies = data_->getFrequencies();
 
-    MatrixXcd Dk = MatrixXcd::Zero(Ns,N);
-    for (size_t m = 0; m < N; ++m) {
-        for (size_t i = 0; i < Ns; ++i) {
-            Dk(i,m) = Complex(1.0, 0) / (samples_[i].first - poles_(m));
-        }
-    }
-
-    std::vector<Sample> res(
-            Ns, Sample(Complex(0.0,0.0), std::vector<Complex>(Nc)));
-    MatrixXcd fit = MatrixXcd::Zero(Nc,Ns);
-
+    // Products with the basis of every response at once, see Cauchy.
+    MatrixXcd res =
+            Cauchy(frequencies, poles_, options_.getEvaluationTolerance())
+                .multiply(C_.leftCols(N).transpose());
     for (size_t n = 0; n < Nc; ++n) {
-        fit.block(n,0,1,Ns) = (Dk * C_.block(n,0,1,N).transpose()).transpose();
         switch (options_.getAsymptoticTrend()) {
         case Options::zero:
             break;
         case Options::constant:
-            for (size_t i = 0; i < Ns; ++i) {
-                fit(n,i) += D_(n);
-            }
+            res.col(n).array() += D_(n);
             break;
         case Options::linear:
-            for (size_t i = 0; i < Ns; ++i) {
-                fit(n,i) += D_(n) + samples_[i].first * E_(n);
-            }
+            res.col(n).array() += D_(n);
+            res.col(n) += frequencies * E_(n);
         }
-        for (size_t i = 0; i < Ns; ++i) {
-            res[i].first = samples_[i].first;
-            res[i].second[n] = fit(n,i);
+    }
+    return res;
+}
+
+/**
+ * Return the fitted samples: a vector of pairs s <-> f(s), where f(s) is
+ * computed with the model in (2).
+ * @return A std::vector of Samples obtained with the fitted parameters.
+ */
+std::vector<Sample> VectorFitting::getFittedSamples() const {
+    const size_t Ns = getSamplesSize();
+    const size_t Nc = getResponseSize();
+    const VectorXcd& frequencies = data_->getFrequencies();
+    const MatrixXcd fit = getFittedResponses();
+
+    std::vector<Sample> res(
+            Ns, Sample(Complex(0.0,0.0), std::vector<Complex>(Nc)));
+    for (size_t i = 0; i < Ns; ++i) {
+        res[i].first = frequencies(i);
+        for (size_t n = 0; n < Nc; ++n) {
+            res[i].second[n] = fit(i,n);
         }
     }
     return res;
@@ -646,66 +850,225 @@ std::vector<Complex> VectorFitting::getPoles() {
     return res;
 }
 
+void VectorFitting::getErrors(Real& rmse, Real& maxDeviation,
+                              std::vector<Real>* sampleErrors) const {
+    const size_t Ns = getSamplesSize();
+    const size_t Nc = getResponseSize();
+    const MatrixXd error =
+            (data_->getResponses() - getFittedResponses()).cwiseAbs2();
+    rmse = std::sqrt(error.sum() / (Real) (Ns*Nc));
+    maxDeviation = std::sqrt(error.maxCoeff());
+    if (sampleErrors != NULL) {
+        sampleErrors->resize(Ns);
+        for (size_t i = 0; i < Ns; ++i) {
+            (*sampleErrors)[i] = std::sqrt(error.row(i).sum() / (Real) Nc);
+        }
+    }
+}
+
 /**
  * Returns the error of the model, measured as the root mean
  * square of the estimated data with respect to the samples.
  * @return Real - Root mean square error of the model.
  */
 Real VectorFitting::getRMSE() const {
-    std::vector<Sample> fittedSamples = getFittedSamples();
+    Real rmse, maxDeviation;
+    getErrors(rmse, maxDeviation, NULL);
+    return rmse;
+}
+
+Real VectorFitting::getMaxDeviation() const {
+    Real rmse, maxDeviation;
+    getErrors(rmse, maxDeviation, NULL);
+    return maxDeviation;
+}
+
+std::vector<Real> VectorFitting::getSampleErrors() const {
+    Real rmse, maxDeviation;
+    std::vector<Real> res;
+    getErrors(rmse, maxDeviation, &res);
+    return res;
+}
 
-    Real error = 0.0;
-    Complex actual, fitted, diff;
+Result VectorFitting::getResult(const std::size_t id,
+                                std::vector<Real>* errors) const {
+    Result res;
+    res.id = id;
+    res.poles = poles_;
+    res.residues = C_;
+    res.D = D_;
+    res.E = E_;
+    res.statistics = statistics_;
+    Statistics::Stopwatch stopwatch(res.statistics);
+    stopwatch.start(Statistics::error);
+    getErrors(res.rmse, res.maxDeviation, errors);
+    stopwatch.stop();
+#ifndef CompileWithoutStatistics
+    res.statistics.flops[Statistics::error] += getErrorFlops();
+#endif
+    return res;
+}
 
-    // Compute the error between the real responses and the fitted ones
-    for (size_t i = 0; i < getSamplesSize(); i++) {
-        // Sanity check: the response should be on the *same* frequency
-        assert(samples_[i].first == fittedSamples[i].first);
+void VectorFitting::setSolverPolicy(const SolverPolicy& policy) {
+    solverPolicy_ = policy;
+}
 
-        // Iterate through all the responses in the vector of each sample
-        for (size_t j = 0; j < samples_[i].second.size(); j++) {
-            // Retrieve the actual and fitted responses
-            actual = samples_[i].second[j];
-            fitted = fittedSamples[i].second[j];
+Options::Solver VectorFitting::getAdaptiveSolver(const Health& previous) {
+    if (!previous.valid || previous.fallbacks > 0) {
+        return Options::householder;
+    }
+    if (previous.reducedCondition > 1e12
+            || previous.sigmaD < 1e-8
+            || previous.escaleSpread > 1e12) {
+        return Options::columnPivoting;
+    }
+    // Normal equations square the condition number, they are kept well
+    // away from losing half of the digits. Hosts where they do not pay off
+    // disable them in their tuning profile.
+    const Tuning& tuning = Tuning::get();
+    if (previous.systemCondition < tuning.normalEquationsCondition
+            && previous.poleMovement < tuning.normalEquationsMovement) {
+        return Options::normalEquations;
+    }
+    return Options::householder;
+}
 
-            diff = actual - fitted;
+Real VectorFitting::getConditionEstimate(const VectorXd& diagonal) {
+    if (diagonal.size() == 0) {
+        return 0.0;
+    }
+    const Real smallest = diagonal.cwiseAbs().minCoeff();
+    if (smallest == 0.0) {
+        return std::numeric_limits<Real>::infinity();
+    }
+    return diagonal.cwiseAbs().maxCoeff() / smallest;
+}
 
-            error += abs(diff * diff);
+Real VectorFitting::getPoleMovement(const VectorXcd& before,
+                                    const VectorXcd& after) {
+    Real res = 0.0;
+    for (int i = 0; i < after.size(); ++i) {
+        Real closest = std::numeric_limits<Real>::max();
+        for (int j = 0; j < before.size(); ++j) {
+            const Real magnitude = std::max(std::abs(before(j)), epsilon);
+            closest = std::min(closest,
+                               std::abs(after(i) - before(j)) / magnitude);
         }
+        res = std::max(res, closest);
     }
-
-    Real res = sqrt(error/((Real)(getSamplesSize()*getResponseSize())));
     return res;
 }
 
-Real VectorFitting::getMaxDeviation() const {
-    std::vector<Sample> fittedSamples = getFittedSamples();
-    std::vector<Real> dev(fittedSamples.size(), 0.0);
+const Statistics& VectorFitting::getStatistics() const {
+    return statistics_;
+}
 
-    for (size_t i = 0; i < fittedSamples.size(); ++i) {
-        std::vector<Real> sampleDev(getResponseSize(), 0.0);
-        for (size_t j = 0; j < getResponseSize(); ++j) {
-            sampleDev[j] = std::abs(
-                    samples_[i].second[j] - fittedSamples[i].second[j]);
-        }
-        dev[i] = *std::max_element(sampleDev.begin(), sampleDev.end());
-    }
-    return *std::max_element(dev.begin(), dev.end());
+Real VectorFitting::getErrorFlops() const {
+    CostModel::Problem problem;
+    problem.Ns = getSamplesSize();
+    problem.N  = getOrder();
+    problem.Nc = getResponseSize();
+    problem.options = options_;
+    return CostModel().estimate(problem).errorFlops;
 }
 
 size_t VectorFitting::getSamplesSize() const {
-    return samples_.size();
+    return data_->getSamplesSize();
 }
 
 size_t VectorFitting::getResponseSize() const {
-    assert(samples_.size() > 0);
-    return samples_.front().second.size();
+    return data_->getResponseSize();
 }
 
 size_t VectorFitting::getOrder() const {
     return (size_t) poles_.rows();
 }
 
+size_t VectorFitting::updateBasis(VectorXcd& poles) {
+    const VectorXcd& frequencies = data_->getFrequencies();
+    const size_t Ns = getSamplesSize();
+    const size_t N  = poles.size();
+    const Options::AsymptoticTrend trend = options_.getAsymptoticTrend();
+    const bool linear = trend == Options::linear;
+    const bool previous = basis_.Dk
+                       && basis_.poles.size() == (long) N
+                       && basis_.Dk->rows() == (long) Ns
+                       && basis_.linear == linear;
+    if (!previous && basisCache_ != NULL) {
+        const std::shared_ptr<const MatrixXcd> cached =
+                basisCache_->get(*data_, poles, trend);
+        if (cached) {
+            basis_.poles = poles;
+            basis_.Dk = cached;
+            basis_.linear = linear;
+            return N;
+        }
+    }
+
+    const Real tolerance = options_.getBasisTolerance();
+    const RowVectorXi cindex = getCIndex(poles);
+    const RowVectorXi previousIndex = previous ? getCIndex(basis_.poles)
+                                               : RowVectorXi();
+    size_t res = 0;
+    std::vector<size_t> moved;
+    for (size_t m = 0; m < N; ++m) {
+        if (cindex(m) == 2) {
+            continue;
+        }
+        const size_t width = cindex(m) == 1 ? 2 : 1;
+        // Kept poles take their previous value back, the basis has to
+        // match the poles exactly.
+        if (previous && cindex(m) == previousIndex(m) &&
+                std::abs(poles(m) - basis_.poles(m))
+                    <= tolerance * std::abs(basis_.poles(m))) {
+            for (size_t k = 0; k < width; ++k) {
+                poles(m+k) = basis_.poles(m+k);
+            }
+            res += width;
+        } else {
+            moved.push_back(m);
+        }
+    }
+
+    if (!previous) {
+        std::shared_ptr<MatrixXcd> Dk = std::make_shared<MatrixXcd>(Ns, N+2);
+        for (size_t i = 0; i < Ns; ++i) {
+            (*Dk)(i,N) = (Real) 1.0;
+            (*Dk)(i,N+1) = linear ? frequencies(i) : Complex(0.0, 0.0);
+        }
+        basis_.Dk = Dk;
+    } else if (!moved.empty() && basis_.Dk.use_count() > 1) {
+        // Shared with the cache or with a copy of this fitter.
+        basis_.Dk = std::make_shared<MatrixXcd>(*basis_.Dk);
+    }
+    if (!moved.empty()) {
+        // Only this fitter holds it, and it was not built const.
+        MatrixXcd& Dk = const_cast<MatrixXcd&>(*basis_.Dk);
+        for (size_t k = 0; k < moved.size(); ++k) {
+            const size_t m = moved[k];
+            const Complex pole = poles(m);
+            if (cindex(m) == 0) { // Real pole.
+                for (size_t i = 0; i < Ns; ++i) {
+                    Dk(i,m) = Complex(1,0) / (frequencies(i) - pole);
+                }
+            } else { // Complex pole, first part.
+                for (size_t i = 0; i < Ns; ++i) {
+                    Dk(i,m)   = Complex(1,0) / (frequencies(i) - pole)
+                              + Complex(1,0) / (frequencies(i) - std::conj(pole));
+                    Dk(i,m+1) = Complex(0,1) / (frequencies(i) - pole)
+                              - Complex(0,1) / (frequencies(i) - std::conj(pole));
+                }
+            }
+        }
+    }
+    basis_.poles = poles;
+    basis_.linear = linear;
+    if (!previous && basisCache_ != NULL) {
+        basisCache_->set(*data_, poles, trend, basis_.Dk);
+    }
+    return res;
+}
+
 RowVectorXi VectorFitting::getCIndex(const VectorXcd& poles) {
     const size_t N = poles.rows();
     RowVectorXi cindex = RowVectorXi::Zero(N);
@@ -730,5 +1093,44 @@ void VectorFitting::setOptions(const Options& options) {
     options_ = options;
 }
 
+void VectorFitting::setFrozenPoles(const std::vector<bool>& frozen) {
+    const size_t N = getOrder();
+    if (frozen.size() != N) {
+        throw std::runtime_error("There must be a flag for each pole");
+    }
+    const RowVectorXi cindex = getCIndex(poles_);
+    for (size_t m = 0; m < N; ++m) {
+        if (cindex(m) == 1 && frozen[m] != frozen[m+1]) {
+            throw std::runtime_error(
+                    "Complex conjugate poles must be frozen together");
+        }
+    }
+
+    // Free poles first, then the frozen ones, each in their order.
+    std::vector<size_t> order;
+    for (size_t m = 0; m < N; ++m) {
+        if (!frozen[m]) {
+            order.push_back(m);
+        }
+    }
+    frozen_ = N - order.size();
+    for (size_t m = 0; m < N; ++m) {
+        if (frozen[m]) {
+            order.push_back(m);
+        }
+    }
+    const VectorXcd poles = poles_;
+    const MatrixXcd C = C_;
+    for (size_t m = 0; m < N; ++m) {
+        poles_(m) = poles(order[m]);
+        if (C.cols() == (long) N) {
+            C_.col(m) = C.col(order[m]);
+        }
+    }
+    if (A_.rows() == (long) N) {
+        A_ = poles_.asDiagonal();
+    }
+}
+
 } /* namespace VectorFitting */
 
@@ -25,15 +25,26 @@
 
 #include <vector>
 #include <complex>
+#include <functional>
+#include <memory>
 #include <eigen3/Eigen/Dense>
 
 #include "Real.h"
 #include "Options.h"
+#include "Result.h"
+#include "Statistics.h"
 
 namespace VectorFitting {
 
 using namespace Eigen;
 
+class BasisCache;
+class Reducer;
+class SampleSet;
+
+// Chooses the solver of an iteration from the health of the previous one.
+typedef std::function<Options::Solver(const Health&)> SolverPolicy;
+
 typedef std::complex<Real> Complex;
 
 /**
@@ -71,12 +82,56 @@ public:
             const std::vector<std::vector<Real>>& weight =
                     std::vector<std::vector<Real>>());
 
+    /**
+     * Build a fitter on a shared sample set, which is neither copied nor
+     * modified. Any number of fitters can share the same set concurrently.
+     * @param data      Data to be fitted and their weights.
+     * @param poles     Starting poles.
+     * @param options   Options.
+     */
+    VectorFitting(const std::shared_ptr<const SampleSet>& data,
+            const std::vector<Complex>& poles,
+            const Options& options);
+
+    /**
+     * Default starting poles: complex conjugate pairs with their imaginary
+     * parts evenly spread over the sampled frequency range.
+     * @param samples   Data to be fitted.
+     * @param order     Number of poles, must be even.
+     */
+    static std::vector<Complex> getStartingPoles(
+            const std::vector<Sample>& samples,
+            const size_t order);
+    // Same, from the cached frequency range of the set.
+    static std::vector<Complex> getStartingPoles(const SampleSet& data,
+                                                 const size_t order);
+
+    /**
+     * Poles of a fit that missed its target, with complex conjugate pairs
+     * added at the frequencies where its error peaks, largest peaks first.
+     * Used to warm start a fit of higher order.
+     * @param data      Fitted data.
+     * @param poles     Current poles.
+     * @param errors    Error at each sample, see getSampleErrors().
+     * @param pairs     Number of pairs to add, fewer when there are not
+     *                  as many peaks.
+     */
+    static std::vector<Complex> getRefinedPoles(
+            const SampleSet& data,
+            const std::vector<Complex>& poles,
+            const std::vector<Real>& errors,
+            const size_t pairs);
+
     // This could be called from the constructor, but if an iterative algorithm
-    // is preferred, it's a good idea to have it as a public method
-    void fit();
+    // is preferred, it's a good idea to have it as a public method.
+    // Returns where the time of this call went.
+    Statistics fit();
 
     std::vector<Sample>  getFittedSamples() const;
     std::vector<Complex> getPoles();
+    const std::shared_ptr<const SampleSet>& getSampleSet() const {
+        return data_;
+    }
 
     /**
      *  Getters to fitting coefficents.
@@ -88,33 +143,133 @@ public:
     VectorXcd getE() {return E_;}    // Size:  1, Nc.
     Real getRMSE() const;
     Real getMaxDeviation() const;
+    // RMS over the responses of the error at each sample.
+    std::vector<Real> getSampleErrors() const;
+
+    /**
+     * Compact copy of the current model and its metrics, suitable to be
+     * moved into a ResultChannel. The model is evaluated once for all of
+     * them.
+     * @param id        Identifier attached to the result.
+     * @param errors    If not NULL, receives getSampleErrors() of the same
+     *                  evaluation.
+     */
+    Result getResult(const std::size_t id = 0,
+                     std::vector<Real>* errors = NULL) const;
+
+    // Of the last call to fit().
+    const Statistics& getStatistics() const;
+
+    /**
+     * Overrides the solver of the options on every call to fit(). The
+     * policy receives the health of the previous call, invalid on the
+     * first one.
+     */
+    void setSolverPolicy(const SolverPolicy& policy);
+
+    /**
+     * Default policy: normal equations while systems are well conditioned
+     * and poles settled, column pivoting when the reduced system is nearly
+     * singular and Householder QR otherwise.
+     */
+    static Options::Solver getAdaptiveSolver(const Health& previous);
+
     void setOptions(const Options& options);
 
+    /**
+     * Keeps some poles fixed on later calls to fit(), such as known
+     * physical poles or converged ones: sigma and its zeros only involve
+     * the free poles. Residues of all of them are still identified, so the
+     * per response systems keep a column for every pole and only their
+     * reduced blocks shrink. Frozen poles move after the free ones in
+     * getPoles(), keeping their order.
+     * @param frozen    A flag for each pole of getPoles(). Complex conjugate
+     *                  pairs must be frozen together.
+     */
+    void setFrozenPoles(const std::vector<bool>& frozen);
+    // Number of poles at the end of getPoles() kept fixed.
+    std::size_t getFrozenSize() const {return frozen_;}
+
+    /**
+     * Shares this fit with other participants, see Reducer. The reducer is
+     * not owned and NULL (the default) fits all the responses locally.
+     */
+    void setReducer(Reducer* reducer) {reducer_ = reducer;}
+
+    /**
+     * Shares the basis of fits that start from the same poles on the same
+     * grid, see BasisCache. Not owned, NULL (the default) builds it.
+     */
+    void setBasisCache(BasisCache* basisCache) {basisCache_ = basisCache;}
+
+    /**
+     * Threads of the per response loops of this fitter. Zero (the default)
+     * takes them from the fit threads of the tuning profile.
+     */
+    void setThreads(const std::size_t threads) {threads_ = threads;}
+
 private:
     Options options_;
 
-    std::vector<Sample> samples_;
+    std::shared_ptr<const SampleSet> data_;
     VectorXcd poles_;
+    std::size_t frozen_;
 
     MatrixXcd A_, C_;
     VectorXcd D_, E_;
     RowVectorXi B_;
 
-    MatrixXd weights_; // Size: Ns, Nc
+    Reducer* reducer_;
+
+    // Last Dk built, for the poles it was built with. Pole identification
+    // starts from the poles residue identification ended with, so both
+    // stages share it. See updateBasis().
+    struct Basis {
+        VectorXcd poles;
+        std::shared_ptr<const MatrixXcd> Dk;   // Size: Ns, N+2.
+        bool linear;
+    };
+    Basis basis_;
+    BasisCache* basisCache_;
+    std::size_t threads_;
+
+    Statistics statistics_;
+    SolverPolicy solverPolicy_;
 
     static constexpr Real toleranceLow_  = 1e-18;
     static constexpr Real toleranceHigh_ = 1e+18;
 
-    void init(const std::vector<Sample>& samples,
+    void init(const std::shared_ptr<const SampleSet>& data,
               const std::vector<Complex>& poles,
-              const Options& options,
-              const std::vector<std::vector<Real>>& weights);
+              const Options& options);
 
     size_t getSamplesSize() const;
     size_t getResponseSize() const;
     size_t getOrder() const;
+    Real getErrorFlops() const;
+
+    // Model at every sample, Ns x Nc.
+    MatrixXcd getFittedResponses() const;
+    // Metrics of a single evaluation of the model, sample errors if not NULL.
+    void getErrors(Real& rmse, Real& maxDeviation,
+                   std::vector<Real>* sampleErrors) const;
+
+    /**
+     * Brings basis_ up to date with poles, recomputing only the columns of
+     * the poles that moved more than the basis tolerance of the options.
+     * The others keep their previous pole, which is written back to poles.
+     * The last two columns are 1 and, for a linear trend, s.
+     * @return Number of pole columns kept.
+     */
+    size_t updateBasis(VectorXcd& poles);
 
+    static std::vector<Complex> getStartingPoles(
+            const std::pair<Real, Real>& range,
+            const size_t order);
     static RowVectorXi getCIndex(const VectorXcd& poles);
+    static Real getConditionEstimate(const VectorXd& diagonal);
+    static Real getPoleMovement(const VectorXcd& before,
+                                const VectorXcd& after);
 };
 
 } /* namespace VectorFitting */